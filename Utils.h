@@ -1,7 +1,6 @@
 #pragma once
 
 #include <array>
-#include <list>
 #include <random>
 #include <sstream>
 #include <string>
@@ -92,10 +91,3 @@ moveToArray(SourceColl_t source) {
   return a;
 }
 
-template <class T>
-static std::list<T> concatLists(std::list<T> l1, std::list<T> l2) {
-  std::list<uint32_t> concatenation;
-  concatenation.splice(concatenation.end(), std::move(l1));
-  concatenation.splice(concatenation.end(), std::move(l2));
-  return concatenation;
-}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <codegen/CodeGeneratorSelector.h>
+#include <codegen/L1IfThenElse.h>
+#include <driver/JitDriver.h>
+
+#include "benchmark/Shared.h"
+
+auto BMPerRowCalls = [](::benchmark::State& st, int id, int depth, int features, int rows) {
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+  JitDriver jitDriver;
+  JitCompileResult jitResult = jitDriver.run(std::move(tree));
+  JitCompileResult::Evaluator_f *compiledResolver = jitResult.EvaluatorFunction;
+
+  float *data = selectDataSetBlock(id, features, rows);
+  size_t stride = selectDataSetStride(id, features);
+  std::vector<uint64_t> results(rows);
+
+  while (st.KeepRunning()) {
+    for (int i = 0; i < rows; i++)
+      results[i] = compiledResolver(data + i * stride);
+
+    benchmark::DoNotOptimize(results.data());
+  }
+
+  st.SetItemsProcessed(st.iterations() * rows);
+};
+
+auto BMBatchCall = [](::benchmark::State& st, int id, int depth, int features, int rows) {
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+  JitDriver jitDriver;
+  JitCompileResult jitResult = jitDriver.run(std::move(tree));
+  JitCompileResult::BatchEvaluator_f *compiledResolver =
+      jitResult.BatchEvaluatorFunction;
+
+  float *data = selectDataSetBlock(id, features, rows);
+  size_t stride = selectDataSetStride(id, features);
+  std::vector<uint64_t> results(rows);
+
+  while (st.KeepRunning()) {
+    compiledResolver(data, stride, rows, results.data());
+    benchmark::DoNotOptimize(results.data());
+  }
+
+  st.SetItemsProcessed(st.iterations() * rows);
+};
+
+auto BMBatchCallColumnMajor = [](::benchmark::State& st, int id, int depth, int features, int rows) {
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+  JitDriver jitDriver;
+  jitDriver.setDataSetLayout(DataSetLayout::ColumnMajor);
+
+  JitCompileResult jitResult = jitDriver.run(std::move(tree));
+  JitCompileResult::BatchEvaluator_f *compiledResolver =
+      jitResult.BatchEvaluatorFunction;
+
+  // same amount of random data, interpreted as features columns of rows items
+  float *data = selectDataSetBlock(id, features, rows);
+  std::vector<uint64_t> results(rows);
+
+  while (st.KeepRunning()) {
+    compiledResolver(data, rows, rows, results.data());
+    benchmark::DoNotOptimize(results.data());
+  }
+
+  st.SetItemsProcessed(st.iterations() * rows);
+};
+
+// same as BMBatchCall, but with the given code generators
+auto makeBMBatchCall(std::shared_ptr<CodeGeneratorSelector> codegenSel) {
+  return [codegenSel](::benchmark::State& st, int id, int depth, int features, int rows) {
+    DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+    JitDriver jitDriver;
+    jitDriver.setCodegenSelector(codegenSel);
+
+    JitCompileResult jitResult = jitDriver.run(std::move(tree));
+    JitCompileResult::BatchEvaluator_f *compiledResolver =
+        jitResult.BatchEvaluatorFunction;
+
+    float *data = selectDataSetBlock(id, features, rows);
+    size_t stride = selectDataSetStride(id, features);
+    std::vector<uint64_t> results(rows);
+
+    while (st.KeepRunning()) {
+      compiledResolver(data, stride, rows, results.data());
+      benchmark::DoNotOptimize(results.data());
+    }
+
+    st.SetItemsProcessed(st.iterations() * rows);
+  };
+}
+
+auto makeL1IfThenElseSelector() {
+  return makeLambdaSelector(
+      [](const CompilerSession &session, int remainingLevels) {
+        static L1IfThenElse codegen;
+        return &codegen;
+      });
+}
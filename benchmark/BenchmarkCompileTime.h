@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <sys/resource.h>
+
+#include <benchmark/benchmark.h>
+#include <codegen/CodeGeneratorSelector.h>
+#include <codegen/L1IfThenElse.h>
+#include <codegen/L3SubtreeSwitchAVX.h>
+#include <codegen/LXSubtreeSwitch.h>
+#include <compiler/DecisionTreeCompiler.h>
+#include <driver/JitDriver.h>
+#include <driver/utility/AutoSetUpTearDownLLVM.h>
+
+#include "benchmark/Shared.h"
+
+enum class CompileTimeCodegen {
+  L1IfThenElse,
+  L2SubtreeSwitch,
+  L3SubtreeSwitchAVX,
+  Adaptive
+};
+
+// Levels that don't fill up a complete subtree switch use L1IfThenElse, so
+// all code generators can compile trees of any depth.
+std::shared_ptr<CodeGeneratorSelector>
+makeCompileTimeSelector(CompileTimeCodegen kind) {
+  switch (kind) {
+    case CompileTimeCodegen::L1IfThenElse:
+      return makeLambdaSelector(
+          [](const CompilerSession &session, int remainingLevels) {
+            static L1IfThenElse codegen;
+            return &codegen;
+          });
+
+    case CompileTimeCodegen::L2SubtreeSwitch:
+      return makeLambdaSelector(
+          [](const CompilerSession &session, int remainingLevels) {
+            static L1IfThenElse remainder;
+            static LXSubtreeSwitch codegen(2);
+            return (remainingLevels < 2) ? (CodeGenerator *)&remainder
+                                         : (CodeGenerator *)&codegen;
+          });
+
+    case CompileTimeCodegen::L3SubtreeSwitchAVX:
+      return makeLambdaSelector(
+          [](const CompilerSession &session, int remainingLevels) {
+            static L1IfThenElse remainder;
+            static L3SubtreeSwitchAVX codegen;
+            return (remainingLevels < 3) ? (CodeGenerator *)&remainder
+                                         : (CodeGenerator *)&codegen;
+          });
+
+    case CompileTimeCodegen::Adaptive:
+      return std::make_shared<DefaultSelector>();
+  }
+
+  llvm_unreachable("Unknown code generator");
+}
+
+// Resident set sizes in KB. ru_maxrss is the high-water mark of the whole
+// process and never drops, so it would report the peak of whatever ran
+// before. On Linux the kernel resets the mark on request, so each benchmark
+// measures the growth over the resident set it started with. Elsewhere the
+// growth of the process peak is a lower bound.
+#ifdef __linux__
+uint64_t readProcStatusKB(const char *key) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  size_t keyLength = std::strlen(key);
+
+  while (std::getline(status, line))
+    if (line.compare(0, keyLength, key) == 0)
+      return std::strtoull(line.c_str() + keyLength, nullptr, 10);
+
+  return 0;
+}
+
+uint64_t startPeakResidentSetMeasurement() {
+  std::ofstream("/proc/self/clear_refs") << "5";
+  return readProcStatusKB("VmRSS:");
+}
+
+uint64_t getPeakResidentSetKB() {
+  return readProcStatusKB("VmHWM:");
+}
+#else
+uint64_t getPeakResidentSetKB() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024; // bytes
+#else
+  return usage.ru_maxrss; // kilobytes
+#endif
+}
+
+uint64_t startPeakResidentSetMeasurement() {
+  return getPeakResidentSetKB();
+}
+#endif
+
+// reports compiled nodes per second as items/s and the growth of the peak
+// memory since startKB as label
+void reportCompileTimeCounters(::benchmark::State& st, int depth,
+                               uint64_t startKB) {
+  uint64_t peakKB = std::max(getPeakResidentSetKB(), startKB);
+  st.SetItemsProcessed(st.iterations() * TreeNodes(depth));
+  st.SetLabel("peak RSS +" + std::to_string((peakKB - startKB) / 1024) +
+              " MB");
+}
+
+// time to compile a tree and load it into the JIT
+auto makeBMCompileEndToEnd(CompileTimeCodegen codegen) {
+  return [codegen](::benchmark::State& st, int id, int depth, int features) {
+    DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+    uint64_t startKB = startPeakResidentSetMeasurement();
+
+    while (st.KeepRunning()) {
+      st.PauseTiming();
+      DecisionTreeHandle model = tree;
+      st.ResumeTiming();
+
+      JitDriver jitDriver;
+      jitDriver.setCodegenSelector(makeCompileTimeSelector(codegen));
+      benchmark::DoNotOptimize(
+          jitDriver.run(std::move(model)).EvaluatorFunction);
+    }
+
+    reportCompileTimeCounters(st, depth, startKB);
+  };
+}
+
+// time to emit the IR only, without optimization and machine code
+auto makeBMCompileFrontend(CompileTimeCodegen codegen) {
+  return [codegen](::benchmark::State& st, int id, int depth, int features) {
+    DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+    AutoSetUpTearDownLLVM llvm;
+    uint64_t startKB = startPeakResidentSetMeasurement();
+
+    while (st.KeepRunning()) {
+      st.PauseTiming();
+      {
+        // a fresh context per iteration, so types and constants are not
+        // reused from previous iterations
+        DecisionTreeCompiler frontend(llvm.getTargetMachine());
+        frontend.setCodegenSelector(makeCompileTimeSelector(codegen));
+        DecisionTreeHandle model = tree;
+        st.ResumeTiming();
+
+        CompileResult result = frontend.compile(std::move(model));
+        benchmark::DoNotOptimize(result.Module.get());
+        st.PauseTiming();
+      }
+      st.ResumeTiming();
+    }
+
+    reportCompileTimeCounters(st, depth, startKB);
+  };
+}
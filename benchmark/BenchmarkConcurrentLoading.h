@@ -0,0 +1,36 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <driver/JitDriver.h>
+
+#include "benchmark/Shared.h"
+
+// wall time for loading one tree per thread, each into its own JIT
+auto BMConcurrentLoading = [](::benchmark::State& st, int id, int depth, int features, int threads) {
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+  while (st.KeepRunning()) {
+    st.PauseTiming();
+    std::vector<DecisionTreeHandle> models;
+    for (int i = 0; i < threads; i++)
+      models.push_back(tree);
+    st.ResumeTiming();
+
+    std::vector<std::thread> loaders;
+    for (DecisionTreeHandle &model : models) {
+      loaders.emplace_back([&model]() {
+        JitDriver jitDriver;
+        benchmark::DoNotOptimize(
+            jitDriver.run(std::move(model)).EvaluatorFunction);
+      });
+    }
+
+    for (std::thread &loader : loaders)
+      loader.join();
+  }
+
+  st.SetItemsProcessed(st.iterations() * threads);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <driver/JitDriver.h>
+
+#include "benchmark/Shared.h"
+
+auto BMForestPerTreeCalls = [](::benchmark::State& st, int id, int depth, int features, int trees) {
+  std::vector<DecisionTreeHandle> forest = selectForest(id, depth, features, trees);
+
+  // one module and one indirect call per tree
+  JitDriver jitDriver;
+  std::vector<JitCompileResult::Evaluator_f *> compiledResolvers;
+  for (DecisionTreeHandle &tree : forest)
+    compiledResolvers.push_back(jitDriver.run(std::move(tree)).EvaluatorFunction);
+
+  while (st.KeepRunning()) {
+    float *data = selectRandomDataSet(id, features);
+
+    uint64_t sum = 0;
+    for (JitCompileResult::Evaluator_f *compiledResolver : compiledResolvers)
+      sum += compiledResolver(data);
+
+    benchmark::DoNotOptimize(sum);
+  }
+
+  st.SetItemsProcessed(st.iterations() * trees);
+};
+
+auto BMForestSingleFunction = [](::benchmark::State& st, int id, int depth, int features, int trees) {
+  std::vector<DecisionTreeHandle> forest = selectForest(id, depth, features, trees);
+
+  JitDriver jitDriver;
+  JitForestCompileResult jitResult = jitDriver.run(std::move(forest));
+  JitForestCompileResult::Evaluator_f *compiledResolver =
+      jitResult.EvaluatorFunction;
+
+  while (st.KeepRunning()) {
+    float *data = selectRandomDataSet(id, features);
+    benchmark::DoNotOptimize(compiledResolver(data));
+  }
+
+  st.SetItemsProcessed(st.iterations() * trees);
+};
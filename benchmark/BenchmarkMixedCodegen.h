@@ -6,7 +6,7 @@
 #include "benchmark/Shared.h"
 
 auto BMCodegenAdaptive = [](::benchmark::State& st, int id, int depth, int features) {
-  DecisionTree tree = selectDecisionTree(id, depth, features);
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
 
   JitDriver jitDriver;
   JitCompileResult jitResult = jitDriver.run(std::move(tree));
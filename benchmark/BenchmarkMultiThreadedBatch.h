@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <driver/BatchEvaluator.h>
+#include <driver/JitDriver.h>
+
+#include "benchmark/Shared.h"
+
+auto BMMultiThreadedBatch = [](::benchmark::State& st, int id, int depth, int features, int rows, int threads) {
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+  JitDriver jitDriver;
+  JitCompileResult jitResult = jitDriver.run(std::move(tree));
+  JitCompileResult::BatchEvaluator_f *compiledResolver =
+      jitResult.BatchEvaluatorFunction;
+
+  BatchEvaluator evaluator(threads);
+  float *data = selectDataSetBlock(id, features, rows);
+  size_t stride = selectDataSetStride(id, features);
+  std::vector<uint64_t> results(rows);
+
+  while (st.KeepRunning()) {
+    evaluator.run(compiledResolver, data, stride, rows, results.data());
+    benchmark::DoNotOptimize(results.data());
+  }
+
+  st.SetItemsProcessed(st.iterations() * rows);
+};
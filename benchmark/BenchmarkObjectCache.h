@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <compiler/ObjectFileCache.h>
+#include <driver/JitDriver.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+
+#include "benchmark/Shared.h"
+
+std::string makeBenchmarkCacheDir() {
+  llvm::SmallString<256> dirName;
+  std::error_code EC =
+      llvm::sys::fs::createUniqueDirectory("EvalTreeJit-cache", dirName);
+  assert(!EC);
+  return dirName.str();
+}
+
+void removeBenchmarkCacheDir(const std::string &cacheDir) {
+  ObjectFileCache(cacheDir).clear();
+  llvm::sys::fs::remove(cacheDir);
+}
+
+// time from loading a model to the first result with an empty object cache
+auto BMStartupColdCache = [](::benchmark::State& st, int id, int depth, int features) {
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+  while (st.KeepRunning()) {
+    st.PauseTiming();
+    std::string cacheDir = makeBenchmarkCacheDir();
+    DecisionTreeHandle model = tree;
+    st.ResumeTiming();
+
+    JitDriver jitDriver;
+    jitDriver.enableObjectCache(cacheDir);
+    JitCompileResult result = jitDriver.run(std::move(model));
+    benchmark::DoNotOptimize(
+        result.EvaluatorFunction(selectRandomDataSet(id, features)));
+
+    st.PauseTiming();
+    removeBenchmarkCacheDir(cacheDir);
+    st.ResumeTiming();
+  }
+};
+
+// same, but the model's object was cached by a previous process
+auto BMStartupWarmCache = [](::benchmark::State& st, int id, int depth, int features) {
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+  std::string cacheDir = makeBenchmarkCacheDir();
+  {
+    JitDriver jitDriver;
+    jitDriver.enableObjectCache(cacheDir);
+    jitDriver.run(tree);
+  }
+
+  while (st.KeepRunning()) {
+    st.PauseTiming();
+    DecisionTreeHandle model = tree;
+    st.ResumeTiming();
+
+    JitDriver jitDriver;
+    jitDriver.enableObjectCache(cacheDir);
+    JitCompileResult result = jitDriver.run(std::move(model));
+    benchmark::DoNotOptimize(
+        result.EvaluatorFunction(selectRandomDataSet(id, features)));
+  }
+
+  removeBenchmarkCacheDir(cacheDir);
+};
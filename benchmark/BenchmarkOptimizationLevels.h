@@ -0,0 +1,43 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <compiler/OptimizationLevel.h>
+#include <driver/JitDriver.h>
+
+#include "benchmark/Shared.h"
+
+// time to compile a tree with the given pipeline
+auto makeBMCompileOptimized(OptimizationLevel level) {
+  return [level](::benchmark::State& st, int id, int depth, int features) {
+    DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+    while (st.KeepRunning()) {
+      st.PauseTiming();
+      DecisionTreeHandle model = tree;
+      st.ResumeTiming();
+
+      JitDriver jitDriver;
+      jitDriver.setOptimizationLevel(level);
+      benchmark::DoNotOptimize(
+          jitDriver.run(std::move(model)).EvaluatorFunction);
+    }
+  };
+}
+
+// evaluation speed of the code it produces
+auto makeBMEvaluateOptimized(OptimizationLevel level) {
+  return [level](::benchmark::State& st, int id, int depth, int features) {
+    DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+    JitDriver jitDriver;
+    jitDriver.setOptimizationLevel(level);
+    JitCompileResult jitResult = jitDriver.run(std::move(tree));
+    JitCompileResult::Evaluator_f *compiledResolver =
+        jitResult.EvaluatorFunction;
+
+    while (st.KeepRunning()) {
+      float *data = selectRandomDataSet(id, features);
+      benchmark::DoNotOptimize(compiledResolver(data));
+    }
+  };
+}
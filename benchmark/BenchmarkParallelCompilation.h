@@ -0,0 +1,53 @@
+#pragma once
+
+#include <thread>
+
+#include <benchmark/benchmark.h>
+#include <driver/JitDriver.h>
+
+#include "benchmark/Shared.h"
+
+// time to compile a deep tree as one function
+auto BMCompileSingleFunction = [](::benchmark::State& st, int id, int depth, int features) {
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+  while (st.KeepRunning()) {
+    st.PauseTiming();
+    DecisionTreeHandle model = tree;
+    st.ResumeTiming();
+
+    JitDriver jitDriver;
+    benchmark::DoNotOptimize(jitDriver.run(std::move(model)).EvaluatorFunction);
+  }
+};
+
+// same, with 16 subtree modules compiled on all cores
+auto BMCompileParallel = [](::benchmark::State& st, int id, int depth, int features) {
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+  while (st.KeepRunning()) {
+    st.PauseTiming();
+    DecisionTreeHandle model = tree;
+    st.ResumeTiming();
+
+    JitDriver jitDriver;
+    jitDriver.setParallelCompile(4, threads);
+    benchmark::DoNotOptimize(jitDriver.run(std::move(model)).EvaluatorFunction);
+  }
+};
+
+// same, with only the top 4 levels compiled before the first call
+auto BMCompileLazy = [](::benchmark::State& st, int id, int depth, int features) {
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
+
+  while (st.KeepRunning()) {
+    st.PauseTiming();
+    DecisionTreeHandle model = tree;
+    st.ResumeTiming();
+
+    JitDriver jitDriver;
+    jitDriver.setLazyCompile(4);
+    benchmark::DoNotOptimize(jitDriver.run(std::move(model)).EvaluatorFunction);
+  }
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include <benchmark/benchmark.h>
+#include <compiler/PooledMemoryManager.h>
+#include <driver/JitDriver.h>
+
+#include "benchmark/Shared.h"
+
+// Counts the iTLB misses of the calling thread in user space. Only available
+// on Linux with access to perf events (see perf_event_paranoid).
+class ITLBMissCounter {
+public:
+  ITLBMissCounter() {
+#ifdef __linux__
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_ITLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    Fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+  }
+
+  ~ITLBMissCounter() {
+    if (Fd >= 0)
+      close(Fd);
+  }
+
+  ITLBMissCounter(const ITLBMissCounter &) = delete;
+  ITLBMissCounter &operator=(const ITLBMissCounter &) = delete;
+
+  bool isAvailable() const { return Fd >= 0; }
+
+  void start() {
+#ifdef __linux__
+    if (Fd >= 0) {
+      ioctl(Fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(Fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  uint64_t stop() {
+    uint64_t count = 0;
+#ifdef __linux__
+    if (Fd >= 0) {
+      ioctl(Fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(Fd, &count, sizeof(count)) != sizeof(count))
+        count = 0;
+    }
+#endif
+    return count;
+  }
+
+private:
+  int Fd = -1;
+};
+
+// Evaluate one row on each of many separately loaded models, like a service
+// that serves hundreds of models does. Reports iTLB misses per model call.
+auto makeBMMultiModel(bool pooled) {
+  return [pooled](::benchmark::State& st, int id, int depth, int features,
+                  int models) {
+    std::vector<DecisionTreeHandle> trees =
+        selectForest(id, depth, features, models);
+
+    JitDriver jitDriver;
+    if (pooled)
+      jitDriver.setCodeMemoryPool(std::make_shared<CodeMemoryPool>());
+
+    std::vector<JitCompileResult::Evaluator_f *> compiledResolvers;
+    for (DecisionTreeHandle &tree : trees)
+      compiledResolvers.push_back(
+          jitDriver.run(std::move(tree)).EvaluatorFunction);
+
+    ITLBMissCounter itlbMisses;
+    itlbMisses.start();
+
+    while (st.KeepRunning()) {
+      float *data = selectRandomDataSet(id, features);
+
+      uint64_t sum = 0;
+      for (JitCompileResult::Evaluator_f *compiledResolver : compiledResolvers)
+        sum += compiledResolver(data);
+
+      benchmark::DoNotOptimize(sum);
+    }
+
+    uint64_t misses = itlbMisses.stop();
+    st.SetItemsProcessed(st.iterations() * models);
+
+    if (itlbMisses.isAvailable() && st.iterations() > 0) {
+      double perCall = (double)misses / (st.iterations() * models);
+      st.SetLabel("iTLB misses/call " + std::to_string(perCall));
+    } else {
+      st.SetLabel("iTLB misses n/a");
+    }
+  };
+}
@@ -10,7 +10,7 @@
 #include "benchmark/Shared.h"
 
 auto BMCodegenL1IfThenElse = [](::benchmark::State& st, int id, int depth, int features) {
-  DecisionTree tree = selectDecisionTree(id, depth, features);
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
 
   JitDriver jitDriver;
   jitDriver.setCodegenSelector(makeLambdaSelector(
@@ -38,7 +38,7 @@ auto BMCodegenL1IfThenElse = [](::benchmark::State& st, int id, int depth, int f
 };
 
 auto BMCodegenL2SubtreeSwitch = [](::benchmark::State& st, int id, int depth, int features) {
-  DecisionTree tree = selectDecisionTree(id, depth, features);
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
 
   JitDriver jitDriver;
   jitDriver.setCodegenSelector(makeLambdaSelector(
@@ -66,7 +66,7 @@ auto BMCodegenL2SubtreeSwitch = [](::benchmark::State& st, int id, int depth, in
 };
 
 auto BMCodegenL3SubtreeSwitchAVX = [](::benchmark::State& st, int id, int depth, int features) {
-  DecisionTree tree = selectDecisionTree(id, depth, features);
+  DecisionTreeHandle tree = selectDecisionTree(id, depth, features);
 
   JitDriver jitDriver;
   jitDriver.setCodegenSelector(makeLambdaSelector(
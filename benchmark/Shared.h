@@ -1,16 +1,24 @@
 #pragma once
 
 #include <cstdint>
+#include <cstdlib>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
 #include <data/DataSetFactory.h>
+#include <data/DataSetFile.h>
 #include <data/DecisionTree.h>
 #include <data/DecisionTreeNode.h>
 #include <Utils.h>
 
-std::unordered_map<int, DecisionTree> RegularDecisionTrees;
-std::unordered_map<int, std::vector<std::vector<float>>> DataSetCollections;
+// benchmark threads share the trees instead of copying them
+std::unordered_map<int, DecisionTreeHandle> RegularDecisionTrees;
+std::unordered_map<int, std::unique_ptr<MappedDataSet>> DataSetFiles;
+std::unordered_map<int, std::vector<DecisionTreeHandle>> Forests;
 
 std::mutex DataSetIdxsAccess;
 std::unordered_map<uint64_t, std::unordered_map<int, size_t>> DataSetIdxs;
@@ -21,29 +29,100 @@ int makeKeyForDecisionTree(int depth, int features) {
   return features * 100 + depth;
 }
 
+// Random data sets go through a temporary data-set file that is mapped into
+// memory, so they can be larger than the last-level cache.
+void initializeDataSetFile(int features, uint32_t rows) {
+  auto it = DataSetFiles.find(features);
+  if (it != DataSetFiles.end() && it->second->getNumRows() >= rows)
+    return;
+
+  DecisionTree unused;
+  DataSetFactory dsFactory(unused.copy(), features);
+  std::vector<float> block = dsFactory.makeRandomDataSetBlock(rows);
+
+  llvm::SmallString<256> fileName;
+  std::error_code EC =
+      llvm::sys::fs::createTemporaryFile("EvalTreeJit", "data", fileName);
+
+  if (!EC)
+    EC = writeDataSetFile(fileName.str(), block.data(), rows, features, features);
+
+  auto mapped = MappedDataSet::open(fileName.str());
+  llvm::sys::fs::remove(fileName); // mapping stays valid
+
+  if (EC || !mapped) {
+    llvm::errs() << "Failed to create data-set file " << fileName << "\n";
+    exit(EXIT_FAILURE);
+  }
+
+  DataSetFiles[features] = std::move(*mapped);
+}
+
 void initializeSharedData(std::vector<int> treeDepths,
-                          std::vector<int> dataSetFeatures) {
+                          std::vector<int> dataSetFeatures,
+                          uint32_t dataSetRows = 1024) {
   DecisionTreeFactory treeFactory;
-  DecisionTree unused;
 
   for (int features : dataSetFeatures) {
-    DataSetFactory dsFactory(unused.copy(), features);
-    DataSetCollections[features] = dsFactory.makeRandomDataSets(10);
+    initializeDataSetFile(features, dataSetRows);
 
     for (int depth : treeDepths) {
       int key = makeKeyForDecisionTree(depth, features);
-      RegularDecisionTrees[key] = treeFactory.makePerfectRandomTree(depth, features);
+      RegularDecisionTrees[key] =
+          makeTreeHandle(treeFactory.makePerfectRandomTree(depth, features));
     }
   }
 }
 
-DecisionTree selectDecisionTree(int benchmarkId, int depth, int features) {
+void initializeSharedDataBlocks(std::vector<int> dataSetFeatures,
+                                uint32_t rows) {
+  for (int features : dataSetFeatures)
+    initializeDataSetFile(features, rows);
+}
+
+void initializeSharedForests(std::vector<int> treeDepths, int features,
+                             int trees) {
+  DecisionTreeFactory treeFactory;
+
+  for (int depth : treeDepths) {
+    std::vector<DecisionTreeHandle> &forest =
+        Forests[makeKeyForDecisionTree(depth, features)];
+
+    for (int i = 0; i < trees; i++)
+      forest.push_back(
+          makeTreeHandle(treeFactory.makePerfectRandomTree(depth, features)));
+  }
+}
+
+std::vector<DecisionTreeHandle> selectForest(int benchmarkId, int depth,
+                                             int features, int trees) {
+  const std::vector<DecisionTreeHandle> &forest =
+      Forests[makeKeyForDecisionTree(depth, features)];
+  assert(forest.size() >= (size_t)trees);
+
+  return std::vector<DecisionTreeHandle>(forest.begin(),
+                                         forest.begin() + trees);
+}
+
+DecisionTreeHandle selectDecisionTree(int benchmarkId, int depth,
+                                      int features) {
   int key = makeKeyForDecisionTree(depth, features);
-  return RegularDecisionTrees[key].copy();
+  return RegularDecisionTrees[key];
 }
 
 float *selectRandomDataSet(int benchmarkId, int features) {
-  auto &collection = DataSetCollections[features];
-  auto idx = makeRandomInt<size_t>(0, collection.size() - 1);
-  return collection[idx].data();
+  const MappedDataSet &dataSets = *DataSetFiles[features];
+  auto idx = makeRandomInt<uint64_t>(0, dataSets.getNumRows() - 1);
+  return dataSets.getRow(idx);
+}
+
+float *selectDataSetBlock(int benchmarkId, int features, int rows) {
+  const MappedDataSet &dataSets = *DataSetFiles[features];
+  assert(dataSets.getNumRows() >= (uint64_t)rows);
+  return dataSets.getData();
+}
+
+// distance between rows in data-set blocks
+size_t selectDataSetStride(int benchmarkId, int features) {
+  return DataSetFiles[features]->getRowStride();
 }
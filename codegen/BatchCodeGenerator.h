@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "codegen/utility/CGBatchInfo.h"
+
+class CompilerSession;
+
+// Code generators that evaluate a fixed number of data-sets at once within
+// the batch evaluator. Rows that don't fill up a complete block are evaluated
+// one by one with the regular per-row code generators.
+class BatchCodeGenerator {
+public:
+  BatchCodeGenerator() = default;
+  virtual ~BatchCodeGenerator() = default;
+
+  // don't copy or move polymorphic class instances
+  BatchCodeGenerator(BatchCodeGenerator &&) = delete;
+  BatchCodeGenerator(const BatchCodeGenerator &) = delete;
+  BatchCodeGenerator &operator=(BatchCodeGenerator &&) = delete;
+  BatchCodeGenerator &operator=(const BatchCodeGenerator &) = delete;
+
+  // identifies the code generator in CompileStats
+  virtual std::string getName() const = 0;
+
+  virtual uint8_t getRowsPerIteration() const = 0;
+
+  // Emit evaluation of getRowsPerIteration() rows starting at
+  // batch.FirstRowIdx, store their results and branch to the continuation.
+  virtual void emitBatchEvaluation(const CompilerSession &session,
+                                   CGBatchInfo batch) = 0;
+};
@@ -0,0 +1,162 @@
+#include "codegen/BatchDataParallelAVX.h"
+
+#include <vector>
+
+#include <llvm/IR/Intrinsics.h>
+
+#include "codegen/utility/CGNodeTables.h"
+#include "compiler/CompilerSession.h"
+
+using namespace llvm;
+
+void BatchDataParallelAVX::emitBatchEvaluation(const CompilerSession &session,
+                                               CGBatchInfo batch) {
+  assert(isPerfectLevelOrderTree(session));
+
+  IRBuilder<> &builder = session.Builder;
+  builder.SetInsertPoint(batch.EvalBlock);
+
+  CGNodeTables tables(session);
+  LLVMContext &ctx = builder.getContext();
+  Type *int32Ty = Type::getInt32Ty(ctx);
+  Type *int8PtrTy = Type::getInt8PtrTy(ctx);
+
+  std::vector<uint32_t> lanes(Lanes);
+  for (uint8_t lane = 0; lane < Lanes; lane++)
+    lanes[lane] = lane;
+
+  Value *laneIdxs = ConstantDataVector::get(ctx, lanes);
+  Value *ones = builder.CreateVectorSplat(Lanes, ConstantInt::get(int32Ty, 1));
+  Value *strides = builder.CreateVectorSplat(
+      Lanes, builder.CreateTrunc(session.BatchStride, int32Ty));
+
+  // feature offsets are relative to the first value of the block
+  bool rowMajor = (session.Layout == DataSetLayout::RowMajor);
+  Value *blockOffset =
+      rowMajor ? builder.CreateMul(batch.FirstRowIdx, session.BatchStride)
+               : batch.FirstRowIdx;
+
+  Value *blockPtr = builder.CreateBitCast(
+      builder.CreateGEP(session.BatchDataPtr, blockOffset), int8PtrTy);
+  Value *featureIdxsPtr =
+      builder.CreateBitCast(tables.getFeatureIdxTable(), int8PtrTy);
+  Value *biasesPtr = builder.CreateBitCast(tables.getBiasTable(), int8PtrTy);
+
+  Value *rowOffsets = rowMajor ? builder.CreateMul(laneIdxs, strides) : laneIdxs;
+  Value *nodeIdxs = builder.CreateVectorSplat(
+      Lanes, ConstantInt::get(int32Ty, session.Tree->getRootNodeIdx()));
+
+  for (uint8_t level = 0; level < session.Tree->getNumLevels(); level++) {
+    Value *featureIdxs = emitGatherInts(session, featureIdxsPtr, nodeIdxs);
+    Value *featureOffsets =
+        rowMajor ? builder.CreateAdd(rowOffsets, featureIdxs)
+                 : builder.CreateAdd(builder.CreateMul(featureIdxs, strides),
+                                     rowOffsets);
+
+    Value *featureVals = emitGatherFloats(session, blockPtr, featureOffsets);
+    Value *biasVals = emitGatherFloats(session, biasesPtr, nodeIdxs);
+
+    // lanes that compare greater are all-ones, i.e. -1
+    Value *cmpResults = emitCompareGreater(session, featureVals, biasVals);
+
+    Value *leftChildIdxs =
+        builder.CreateAdd(builder.CreateShl(nodeIdxs, 1), ones);
+    nodeIdxs = builder.CreateSub(leftChildIdxs, cmpResults);
+  }
+
+  if (session.Tree->getLeafPayloadKind() == LeafPayloadKind::NodeIdx) {
+    Type *resultsTy = VectorType::get(session.NodeIdxTy, Lanes);
+    Value *results = builder.CreateZExt(nodeIdxs, resultsTy);
+    Value *outputPtr = builder.CreateBitCast(
+        builder.CreateGEP(session.BatchOutputPtr, batch.FirstRowIdx),
+        resultsTy->getPointerTo());
+
+    unsigned alignment = session.NodeIdxTy->getPrimitiveSizeInBits() / 8;
+    builder.CreateAlignedStore(results, outputPtr, alignment);
+  } else {
+    // map result node indices to leaf payloads one lane at a time
+    for (uint8_t lane = 0; lane < Lanes; lane++) {
+      Value *nodeIdx = builder.CreateExtractElement(nodeIdxs, lane);
+      Value *rowIdx = builder.CreateAdd(
+          batch.FirstRowIdx, ConstantInt::get(session.SizeTy, lane));
+
+      builder.CreateStore(tables.emitLoadResult(nodeIdx),
+                          builder.CreateGEP(session.BatchOutputPtr, rowIdx));
+    }
+  }
+
+  builder.CreateBr(batch.ContinuationBlock);
+}
+
+Value *BatchDataParallelAVX::emitGatherInts(const CompilerSession &session,
+                                            Value *basePtr, Value *idxs) {
+  IRBuilder<> &builder = session.Builder;
+  Type *int32Ty = builder.getInt32Ty();
+  Type *avx8IntsTy = VectorType::get(int32Ty, Lanes);
+
+  Function *gatherFn = Intrinsic::getDeclaration(
+      session.Module.get(), Intrinsic::x86_avx2_gather_d_d_256);
+
+  Value *allLanes = Constant::getAllOnesValue(avx8IntsTy);
+  return builder.CreateCall(gatherFn, {
+      Constant::getNullValue(avx8IntsTy), basePtr, idxs, allLanes,
+      builder.getInt8(4) // sizeof(int32_t)
+  });
+}
+
+Value *BatchDataParallelAVX::emitGatherFloats(const CompilerSession &session,
+                                              Value *basePtr, Value *idxs) {
+  IRBuilder<> &builder = session.Builder;
+  Type *avx8FloatsTy = VectorType::get(builder.getFloatTy(), Lanes);
+  Type *avx8IntsTy = VectorType::get(builder.getInt32Ty(), Lanes);
+
+  Function *gatherFn = Intrinsic::getDeclaration(
+      session.Module.get(), Intrinsic::x86_avx2_gather_d_ps_256);
+
+  // gather uses the sign bit of each mask element
+  Value *allLanes = builder.CreateBitCast(
+      Constant::getAllOnesValue(avx8IntsTy), avx8FloatsTy);
+
+  return builder.CreateCall(gatherFn, {
+      Constant::getNullValue(avx8FloatsTy), basePtr, idxs, allLanes,
+      builder.getInt8(4) // sizeof(float)
+  });
+}
+
+Value *BatchDataParallelAVX::emitCompareGreater(const CompilerSession &session,
+                                                Value *lhs, Value *rhs) {
+  IRBuilder<> &builder = session.Builder;
+  Type *avx8IntsTy = VectorType::get(builder.getInt32Ty(), Lanes);
+
+  Function *avxCmpFn = Intrinsic::getDeclaration(session.Module.get(),
+                                                 Intrinsic::x86_avx_cmp_ps_256);
+
+  Value *cmpResults = builder.CreateCall(avxCmpFn, {
+      lhs, rhs, builder.getInt8(14) // _CMP_GT_OS
+  });
+
+  return builder.CreateBitCast(cmpResults, avx8IntsTy);
+}
+
+bool BatchDataParallelAVX::isPerfectLevelOrderTree(
+    const CompilerSession &session) const {
+  // the node tables must be indexed by node index
+  const DecisionTree &tree = *session.Tree;
+  if (!tree.usesNodeIdxAsSlot())
+    return false;
+
+  uint64_t numInnerNodes =
+      DecisionTree::getFirstNodeIdxOnLevel(tree.getNumLevels());
+
+  for (uint64_t idx = 0; idx < numInnerNodes; idx++) {
+    if (!tree.hasNode(idx))
+      return false;
+
+    DecisionTreeNode node = tree.getNode(idx);
+    if (node.getLeftChildIdx() != 2 * idx + 1 ||
+        node.getRightChildIdx() != 2 * idx + 2)
+      return false;
+  }
+
+  return true;
+}
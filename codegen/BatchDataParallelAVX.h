@@ -0,0 +1,35 @@
+#pragma once
+
+#include <llvm/IR/Value.h>
+
+#include "codegen/BatchCodeGenerator.h"
+
+class CGNodeTables;
+
+// Evaluate 8 rows at once with one row per AVX lane. On each level, every
+// lane gathers the feature index and bias of its current node, gathers the
+// referenced feature value from its row and compares. The next node index is
+// computed arithmetically as 2 * idx + 1 + cmp, so the generated code has no
+// branches and its throughput doesn't depend on how predictable the data is.
+//
+// Requires AVX2 and perfect trees with level-order node indices, as built by
+// DecisionTreeFactory. Feature offsets are computed in 32 bit.
+class BatchDataParallelAVX : public BatchCodeGenerator {
+public:
+  constexpr static uint8_t Lanes = 8;
+  uint8_t getRowsPerIteration() const override { return Lanes; }
+  std::string getName() const override { return "BatchDataParallelAVX"; }
+
+  void emitBatchEvaluation(const CompilerSession &session,
+                           CGBatchInfo batch) override;
+
+  bool isPerfectLevelOrderTree(const CompilerSession &session) const;
+
+private:
+  llvm::Value *emitGatherInts(const CompilerSession &session,
+                              llvm::Value *basePtr, llvm::Value *idxs);
+  llvm::Value *emitGatherFloats(const CompilerSession &session,
+                                llvm::Value *basePtr, llvm::Value *idxs);
+  llvm::Value *emitCompareGreater(const CompilerSession &session,
+                                  llvm::Value *lhs, llvm::Value *rhs);
+};
@@ -0,0 +1,53 @@
+#include "codegen/BatchInterleavedSelect.h"
+
+#include <vector>
+
+#include "codegen/utility/CGNodeTables.h"
+#include "compiler/CompilerSession.h"
+
+using namespace llvm;
+
+void BatchInterleavedSelect::emitBatchEvaluation(const CompilerSession &session,
+                                                 CGBatchInfo batch) {
+  IRBuilder<> &builder = session.Builder;
+  builder.SetInsertPoint(batch.EvalBlock);
+
+  CGNodeTables tables(session);
+  Constant *rootSlot = ConstantInt::get(
+      tables.getSlotTy(),
+      session.Tree->getNodeSlot(session.Tree->getRootNodeIdx()));
+
+  std::vector<Value *> rowIdxs;
+  std::vector<Value *> cursors;
+
+  for (uint8_t row = 0; row < Rows; row++) {
+    Constant *rowOffset = ConstantInt::get(session.SizeTy, row);
+    rowIdxs.push_back(builder.CreateAdd(batch.FirstRowIdx, rowOffset));
+    cursors.push_back(rootSlot);
+  }
+
+  // advance all cursors by one level before moving on to the next one
+  std::vector<Value *> cmpResults(Rows);
+  for (uint8_t level = 0; level < session.Tree->getNumLevels(); level++) {
+    for (uint8_t row = 0; row < Rows; row++) {
+      Value *featureIdx = tables.emitLoadFeatureIdx(cursors[row]);
+      Value *featureVal =
+          session.emitLoadBatchFeatureValue(rowIdxs[row], featureIdx);
+
+      Value *biasVal = tables.emitLoadBias(cursors[row]);
+      cmpResults[row] = builder.CreateFCmpOGT(featureVal, biasVal);
+    }
+
+    for (uint8_t row = 0; row < Rows; row++) {
+      cursors[row] = tables.emitLoadChildSlot(cursors[row], cmpResults[row]);
+    }
+  }
+
+  for (uint8_t row = 0; row < Rows; row++) {
+    Value *result = tables.emitLoadResult(cursors[row]);
+    Value *outputPtr = builder.CreateGEP(session.BatchOutputPtr, rowIdxs[row]);
+    builder.CreateStore(result, outputPtr);
+  }
+
+  builder.CreateBr(batch.ContinuationBlock);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "codegen/BatchCodeGenerator.h"
+
+// Evaluate a fixed number of rows at once. Each row has its own cursor that
+// walks the tree through the node tables one level at a time. Child nodes
+// are chosen with selects instead of branches, so there is nothing to
+// mispredict and the out-of-order core can overlap the work of all rows.
+class BatchInterleavedSelect : public BatchCodeGenerator {
+public:
+  BatchInterleavedSelect(uint8_t rows) : Rows(rows) {}
+  uint8_t getRowsPerIteration() const override { return Rows; }
+
+  std::string getName() const override {
+    return "BatchInterleavedSelect" + std::to_string(Rows);
+  }
+
+  void emitBatchEvaluation(const CompilerSession &session,
+                           CGBatchInfo batch) override;
+
+private:
+  uint8_t Rows;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
 #include <vector>
 
 #include "codegen/utility/CGNodeInfo.h"
@@ -18,6 +19,9 @@ public:
   CodeGenerator &operator=(CodeGenerator &&) = delete;
   CodeGenerator &operator=(const CodeGenerator &) = delete;
 
+  // identifies the code generator in CompileStats
+  virtual std::string getName() const = 0;
+
   virtual uint8_t getJointSubtreeDepth() const = 0;
 
   virtual std::vector<CGNodeInfo>
@@ -1,5 +1,9 @@
 #include "codegen/CodeGeneratorSelector.h"
 
+#include <llvm/ADT/StringExtras.h>
+
+#include "codegen/BatchDataParallelAVX.h"
+#include "codegen/BatchInterleavedSelect.h"
 #include "codegen/L1IfThenElse.h"
 #include "codegen/LXSubtreeSwitch.h"
 #include "codegen/L3SubtreeSwitchAVX.h"
@@ -18,3 +22,38 @@ CodeGenerator *DefaultSelector::select(const CompilerSession &session,
 
   return &DefaultL1IfThenElse;
 }
+
+std::string DefaultSelector::getCacheKey() const {
+  return "Default";
+}
+
+InterleavedSelector::InterleavedSelector(uint8_t rows)
+    : BatchCodegen(std::make_unique<BatchInterleavedSelect>(rows)) {}
+
+InterleavedSelector::~InterleavedSelector() = default;
+
+BatchCodeGenerator *
+InterleavedSelector::selectBatch(const CompilerSession &session) {
+  return BatchCodegen.get();
+}
+
+std::string InterleavedSelector::getCacheKey() const {
+  return "Interleaved" + llvm::utostr(BatchCodegen->getRowsPerIteration());
+}
+
+DataParallelAVXSelector::DataParallelAVXSelector()
+    : BatchCodegen(std::make_unique<BatchDataParallelAVX>()) {}
+
+DataParallelAVXSelector::~DataParallelAVXSelector() = default;
+
+BatchCodeGenerator *
+DataParallelAVXSelector::selectBatch(const CompilerSession &session) {
+  if (!Avx2Support || !BatchCodegen->isPerfectLevelOrderTree(session))
+    return nullptr;
+
+  return BatchCodegen.get();
+}
+
+std::string DataParallelAVXSelector::getCacheKey() const {
+  return "DataParallelAVX";
+}
@@ -3,7 +3,11 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <string>
 
+class BatchCodeGenerator;
+class BatchDataParallelAVX;
+class BatchInterleavedSelect;
 class CodeGenerator;
 class CompilerSession;
 
@@ -12,12 +16,49 @@ public:
   virtual ~CodeGeneratorSelector() = default;
   virtual CodeGenerator *select(const CompilerSession &session, int remainingLevels) = 0;
 
+  // batch evaluators process rows one by one if this returns nullptr
+  virtual BatchCodeGenerator *selectBatch(const CompilerSession &session) {
+    return nullptr;
+  }
+
+  // identifies the selector's configuration in object cache keys, selectors
+  // that return an empty string are never cached
+  virtual std::string getCacheKey() const { return std::string{}; }
+
   bool AvxSupport = false;
+  bool Avx2Support = false;
 };
 
 class DefaultSelector : public CodeGeneratorSelector {
 public:
   CodeGenerator *select(const CompilerSession &session, int remainingLevels) override;
+  std::string getCacheKey() const override;
+};
+
+class InterleavedSelector : public DefaultSelector {
+public:
+  InterleavedSelector(uint8_t rows);
+  ~InterleavedSelector();
+
+  BatchCodeGenerator *selectBatch(const CompilerSession &session) override;
+  std::string getCacheKey() const override;
+
+private:
+  std::unique_ptr<BatchInterleavedSelect> BatchCodegen;
+};
+
+// falls back to per-row evaluation on targets without AVX2 and for trees
+// that aren't perfect
+class DataParallelAVXSelector : public DefaultSelector {
+public:
+  DataParallelAVXSelector();
+  ~DataParallelAVXSelector();
+
+  BatchCodeGenerator *selectBatch(const CompilerSession &session) override;
+  std::string getCacheKey() const override;
+
+private:
+  std::unique_ptr<BatchDataParallelAVX> BatchCodegen;
 };
 
 template <class LambdaSelect_f>
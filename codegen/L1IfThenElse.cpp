@@ -6,28 +6,20 @@ using namespace llvm;
 std::vector<CGNodeInfo>
 L1IfThenElse::emitEvaluation(const CompilerSession &session,
                              CGNodeInfo nodeInfo) {
-  DecisionSubtreeRef subtree = session.Tree.getSubtreeRef(nodeInfo.Index, 2);
-  switch (subtree.getNodeCount()) {
-    case 1:
-      assert(subtree.Root.isLeaf());
-      return {std::move(nodeInfo)};
-
-    case 2:
-      return emitSingleChildForward(std::move(nodeInfo),
-                                    std::move(subtree));
-
-    case 3:
-      return emitConditionalBranch(session, std::move(nodeInfo),
-                                   std::move(subtree));
-  }
-
-  llvm_unreachable("2-level subtree must have 1, 2 or 3 nodes");
+  DecisionSubtreeRef subtree = session.Tree->getSubtreeRef(nodeInfo.Index, 1);
+
+  // regular nodes have at least one child, results are continuation nodes
+  if (subtree.Root.hasSingleChild())
+    return emitSingleChildForward(std::move(nodeInfo), std::move(subtree));
+
+  return emitConditionalBranch(session, std::move(nodeInfo),
+                               std::move(subtree));
 }
 
 std::vector<CGNodeInfo>
 L1IfThenElse::emitSingleChildForward(CGNodeInfo nodeInfo,
                                      DecisionSubtreeRef subtree) {
-  assert(subtree.Root.hasLeftChild() != subtree.Root.hasRightChild());
+  assert(subtree.Root.hasSingleChild());
 
   NodeEvaluation onliestEval = subtree.Root.hasLeftChild()
                              ? NodeEvaluation::ContinueZeroLeft
@@ -80,10 +72,7 @@ L1IfThenElse::emitConditionalBranch(const CompilerSession &session,
 
 Value *L1IfThenElse::emitLoadFeatureValue(const CompilerSession &session,
                                           DecisionTreeNode node) {
-  Value *dataSetFeaturePtr = session.Builder.CreateConstGEP1_32(
-      session.InputDataSetPtr, node.getFeatureIdx());
-
-  return session.Builder.CreateLoad(dataSetFeaturePtr);
+  return session.emitLoadFeatureValue(node.getFeatureIdx());
 }
 
 BasicBlock *L1IfThenElse::makeIfThenElseBB(LLVMContext &ctx,
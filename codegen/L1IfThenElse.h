@@ -8,6 +8,7 @@
 class L1IfThenElse : public CodeGenerator {
 public:
   L1IfThenElse() = default;
+  std::string getName() const override { return "L1IfThenElse"; }
   uint8_t getJointSubtreeDepth() const override { return 1; }
 
   std::vector<CGNodeInfo> emitEvaluation(const CompilerSession &session,
@@ -8,6 +8,7 @@ class L3SubtreeSwitchAVX : public LXSubtreeSwitch {
 
 public:
   L3SubtreeSwitchAVX() : LXSubtreeSwitch(Levels) {}
+  std::string getName() const override { return "L3SubtreeSwitchAVX"; }
 
   llvm::Value *emitConditionVector(const CompilerSession &session,
                                    DecisionSubtreeRef subtree,
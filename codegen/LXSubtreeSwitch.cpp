@@ -14,7 +14,7 @@ std::vector<CGNodeInfo>
 LXSubtreeSwitch::emitEvaluation(const CompilerSession &session,
                                 CGNodeInfo subtreeRoot) {
   DecisionSubtreeRef subtreeRef =
-      session.Tree.getSubtreeRef(subtreeRoot.Index, Levels);
+      session.Tree->getSubtreeRef(subtreeRoot.Index, Levels);
 
   Value *conditionVector = emitConditionVector(session, subtreeRef, subtreeRoot);
   LLVMContext &ctx = session.Builder.getContext();
@@ -28,8 +28,12 @@ LXSubtreeSwitch::emitEvaluation(const CompilerSession &session,
   SwitchInst *switchInst = session.Builder.CreateSwitch(
       conditionVector, defaultBB, expectedCaseLabels);
 
-  CGEvaluationPathsBuilder pathBuilder(subtreeRef);
-  std::vector<CGEvaluationPath> evaluationPaths = pathBuilder.run();
+  std::vector<CGEvaluationPath> evaluationPaths;
+  {
+    CompileTimer timer(session.Stats.PathBuilding);
+    CGEvaluationPathsBuilder pathBuilder(subtreeRef);
+    evaluationPaths = pathBuilder.run();
+  }
 
   std::vector<CGNodeInfo> continuationNodes = emitSwitchTargets(
       ctx, evaluationPaths, subtreeRoot.OwnerFunction, returnBB);
@@ -40,8 +44,11 @@ LXSubtreeSwitch::emitEvaluation(const CompilerSession &session,
   CGConditionVectorVariationsBuilder variantsBuilder(subtreeRef);
 
   for (size_t i = 0; i < continuationNodes.size(); i++) {
-    std::vector<uint32_t> pathCaseValues =
-        variantsBuilder.run(std::move(evaluationPaths[i]));
+    std::vector<uint32_t> pathCaseValues;
+    {
+      CompileTimer timer(session.Stats.VariationBuilding);
+      pathCaseValues = variantsBuilder.run(std::move(evaluationPaths[i]));
+    }
 
     emittedCaseLabels +=
         emitSwitchCaseLabels(ctx, switchInst, conditionVector->getType(),
@@ -65,15 +72,22 @@ LXSubtreeSwitch::emitEvaluation(const CompilerSession &session,
 Value *LXSubtreeSwitch::emitLeafEvaluation(const CompilerSession &session,
                                            CGNodeInfo subtreeRoot) {
   DecisionSubtreeRef subtreeRef =
-      session.Tree.getSubtreeRef(subtreeRoot.Index, Levels);
+      session.Tree->getSubtreeRef(subtreeRoot.Index, Levels);
 
-  CGEvaluationPathsBuilder pathBuilder(subtreeRef);
-  std::vector<CGEvaluationPath> evaluationPaths = pathBuilder.run();
+  std::vector<CGEvaluationPath> evaluationPaths;
+  {
+    CompileTimer timer(session.Stats.PathBuilding);
+    CGEvaluationPathsBuilder pathBuilder(subtreeRef);
+    evaluationPaths = pathBuilder.run();
+  }
 
   auto expectedSwitchCases = PowerOf2<uint32_t>(subtreeRef.getNodeCount());
 
-  std::vector<uint64_t> data = collectSwitchTableData(
-      subtreeRef, std::move(evaluationPaths));
+  std::vector<uint64_t> data;
+  {
+    CompileTimer timer(session.Stats.VariationBuilding);
+    data = collectSwitchTableData(subtreeRef, std::move(evaluationPaths));
+  }
 
   assert(data.size() == expectedSwitchCases);
   Constant *switchTable = emitSwitchTable(session, std::move(data));
@@ -119,12 +133,18 @@ uint32_t LXSubtreeSwitch::emitSwitchCaseLabels(
   return pathCaseValues.size();
 }
 
+// The switch table maps condition vectors to the leaf payloads of the result
+// nodes (which are the result node indices for trees without payloads).
 Constant *LXSubtreeSwitch::emitSwitchTable(const CompilerSession &session,
                                            std::vector<uint64_t> data) {
-  LLVMContext &ctx = session.Builder.getContext();
+  std::vector<Constant *> payloads;
+  payloads.reserve(data.size());
+
+  for (uint64_t resultNodeIdx : data)
+    payloads.push_back(session.getResultConstant(resultNodeIdx));
 
-  Type *tableTy = ArrayType::get(session.NodeIdxTy, data.size());
-  Constant *init = ConstantDataArray::get(ctx, std::move(data));
+  ArrayType *tableTy = ArrayType::get(session.getResultTy(), payloads.size());
+  Constant *init = ConstantArray::get(tableTy, payloads);
 
   return new GlobalVariable(*session.Module.get(),
                             tableTy, true,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include <llvm/IR/LLVMContext.h>
@@ -17,6 +18,10 @@ public:
   LXSubtreeSwitch(uint8_t levels) : Levels(levels) {}
   uint8_t getJointSubtreeDepth() const override { return Levels; }
 
+  std::string getName() const override {
+    return "L" + std::to_string(Levels) + "SubtreeSwitch";
+  }
+
   std::vector<CGNodeInfo>
   emitEvaluation(const CompilerSession &session, CGNodeInfo subtreeRoot) override;
 
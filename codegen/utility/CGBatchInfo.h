@@ -0,0 +1,23 @@
+#pragma once
+
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Value.h>
+
+struct CGBatchInfo {
+  CGBatchInfo() = default;
+  CGBatchInfo(CGBatchInfo &&) = default;
+  CGBatchInfo(const CGBatchInfo &) = default;
+  CGBatchInfo &operator=(CGBatchInfo &&) = default;
+  CGBatchInfo &operator=(const CGBatchInfo &) = default;
+
+  CGBatchInfo(llvm::Value *firstRowIdx, llvm::Function *ownerFunction,
+              llvm::BasicBlock *evalBB, llvm::BasicBlock *continuationBB)
+      : FirstRowIdx(firstRowIdx), OwnerFunction(ownerFunction),
+        EvalBlock(evalBB), ContinuationBlock(continuationBB) {}
+
+  llvm::Value *FirstRowIdx;
+  llvm::Function *OwnerFunction;
+  llvm::BasicBlock *EvalBlock;
+  llvm::BasicBlock *ContinuationBlock;
+};
@@ -12,10 +12,7 @@ CGConditionVectorEmitter::CGConditionVectorEmitter(
 
 Value *
 CGConditionVectorEmitter::emitLoadFeatureValue(DecisionTreeNode node) {
-  Value *dataSetFeaturePtr = Builder.CreateConstGEP1_32(
-      Session.InputDataSetPtr, node.getFeatureIdx());
-
-  return Builder.CreateLoad(dataSetFeaturePtr);
+  return Session.emitLoadFeatureValue(node.getFeatureIdx());
 }
 
 // -----------------------------------------------------------------------------
@@ -23,7 +20,7 @@ CGConditionVectorEmitter::emitLoadFeatureValue(DecisionTreeNode node) {
 CGConditionVectorEmitterX86::CGConditionVectorEmitterX86(
     const CompilerSession &session, DecisionSubtreeRef subtree)
     : CGConditionVectorEmitter(session), Subtree(std::move(subtree)),
-      Nodes(moveToVector(Subtree.collectNodesPreOrder())) {
+      Nodes(Subtree.collectNodesPreOrder()) {
   assert(Subtree.getNodeCount() == Nodes.size());
 }
 
@@ -40,7 +37,7 @@ Value *CGConditionVectorEmitterX86::run(CGNodeInfo subtreeRoot) {
   std::vector<Value *> vectorBits;
 
   for (uint8_t bitOffset = 0; bitOffset < Nodes.size(); bitOffset++) {
-    DecisionTreeNode node = Nodes.at(bitOffset);
+    DecisionTreeNode node = Nodes[bitOffset];
     Value *featureVal = nodeFeatureValues.at(bitOffset);
 
     Constant *biasVal = ConstantFP::get(FloatTy, node.getFeatureBias());
@@ -62,8 +59,9 @@ Value *CGConditionVectorEmitterX86::run(CGNodeInfo subtreeRoot) {
 CGConditionVectorEmitterAVX::CGConditionVectorEmitterAVX(
     const CompilerSession &session, DecisionSubtreeRef subtree)
     : CGConditionVectorEmitter(session), Subtree(std::move(subtree)),
-      Nodes(moveToArray<AvxPackSize - 1>(Subtree.collectNodesPreOrder())) {
-  assert(Subtree.getNodeCount() == AvxPackSize - 1);
+      Nodes(Subtree.collectNodesPreOrder()) {
+  assert(Subtree.getNodeCount() == Nodes.size());
+  assert(Nodes.size() < AvxPackSize);
 }
 
 Value *CGConditionVectorEmitterAVX::run(CGNodeInfo subtreeRoot) {
@@ -91,6 +89,12 @@ Value *CGConditionVectorEmitterAVX::emitCollectDataSetValues() {
                         Builder.CreateConstGEP1_32(featureValues, bitOffset++));
   }
 
+  // defined values for absent nodes, their results are masked off anyway
+  for (; bitOffset < AvxPackSize; bitOffset++) {
+    Builder.CreateStore(ConstantFP::get(FloatTy, 0.0),
+                        Builder.CreateConstGEP1_32(featureValues, bitOffset));
+  }
+
   return featureValues;
 }
 
@@ -104,6 +108,11 @@ Value *CGConditionVectorEmitterAVX::emitDefineTreeNodeValues() {
                         Builder.CreateConstGEP1_32(compareValues, bitOffset++));
   }
 
+  for (; bitOffset < AvxPackSize; bitOffset++) {
+    Builder.CreateStore(ConstantFP::get(FloatTy, 0.0),
+                        Builder.CreateConstGEP1_32(compareValues, bitOffset));
+  }
+
   return compareValues;
 }
 
@@ -111,17 +120,14 @@ Value *CGConditionVectorEmitterAVX::emitDefineBitShiftMaskValues() {
   Value *bitShiftValues = Builder.Insert(
       new AllocaInst(Int32Ty, AvxPackSizeVal, AvxAlignment), "bitShiftValues");
 
-  uint8_t numNodes = AvxPackSize - 1;
-  for (uint8_t i = 0; i < numNodes; i++) {
+  for (uint8_t i = 0; i < AvxPackSize; i++) {
+    // AND with 0 masks off lanes without a node, e.g. the unused last one
+    uint32_t mask = (i < Nodes.size()) ? PowerOf2<uint32_t>(i) : 0;
     Builder.CreateStore(
-        ConstantInt::get(Int32Ty, PowerOf2(i)),
+        ConstantInt::get(Int32Ty, mask),
         Builder.CreateConstGEP1_32(bitShiftValues, i));
   }
 
-  // AND with 0 in unused last item
-  Builder.CreateStore(ConstantInt::get(Int32Ty, 0),
-                      Builder.CreateConstGEP1_32(bitShiftValues, numNodes));
-
   return bitShiftValues;
 }
 
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <array>
 #include <cstdint>
 #include <vector>
 
@@ -48,7 +47,7 @@ public:
 
 private:
   DecisionSubtreeRef Subtree;
-  std::vector<DecisionTreeNode> Nodes;
+  DecisionSubtreeRef::NodeVector Nodes;
 };
 
 // -----------------------------------------------------------------------------
@@ -65,7 +64,9 @@ private:
   constexpr static unsigned AvxAlignment = 32;
 
   DecisionSubtreeRef Subtree;
-  std::array<DecisionTreeNode, AvxPackSize - 1> Nodes;
+
+  // lanes without a node are masked off, the last lane is always unused
+  DecisionSubtreeRef::NodeVector Nodes;
 
   llvm::Type *Int8Ty = llvm::Type::getInt8Ty(Ctx);
   llvm::Type *Int32Ty = llvm::Type::getInt32Ty(Ctx);
@@ -1,27 +1,50 @@
 #include "codegen/utility/CGConditionVectorVariationsBuilder.h"
 #include "Utils.h"
 
+// Enumerates all combinations of the variable bits. The first variable bit
+// changes slowest, so variant i has the bits of i from most to least
+// significant.
 std::vector<uint32_t>
-CGConditionVectorVariationsBuilder::run(CGEvaluationPath path) {
-  std::vector<uint8_t> variableBitOffsets = collectVariableBitOffsets(path);
+CGConditionVectorVariationsBuilder::run(const CGEvaluationPath &path) {
+  BitOffsets variableBitOffsets = collectVariableBitOffsets(path);
   uint32_t fixedBitsTemplate = buildFixedBitsTemplate(path);
 
-  if (variableBitOffsets.empty())
-    return {fixedBitsTemplate};
+  size_t numVariableBits = variableBitOffsets.size();
+  auto numVariants = PowerOf2<uint32_t>(numVariableBits);
 
-  std::list<uint32_t> variants =
-      buildVariantsRecursively(fixedBitsTemplate, variableBitOffsets, 0);
+  std::vector<uint32_t> variants;
+  variants.reserve(numVariants);
 
-  assert(variants.size() == PowerOf2(variableBitOffsets.size()));
-  return moveToVector(std::move(variants));
+  for (uint32_t i = 0; i < numVariants; i++) {
+    uint32_t conditionVector = fixedBitsTemplate;
+
+    for (size_t bitToVaryIdx = 0; bitToVaryIdx < numVariableBits;
+         bitToVaryIdx++) {
+      uint8_t bitToVaryOffset = variableBitOffsets[bitToVaryIdx];
+      assert(bitToVaryOffset < sizeof(uint32_t) * 8);
+
+      uint32_t vectorTrueBit = 1u << bitToVaryOffset;
+      assert((fixedBitsTemplate & ~vectorTrueBit) == fixedBitsTemplate);
+
+      if (i & PowerOf2<uint32_t>(numVariableBits - 1 - bitToVaryIdx))
+        conditionVector |= vectorTrueBit;
+    }
+
+    variants.push_back(conditionVector);
+  }
+
+  return variants;
 }
 
 uint32_t CGConditionVectorVariationsBuilder::buildFixedBitsTemplate(
-    CGEvaluationPath path) const {
+    const CGEvaluationPath &path) const {
   uint32_t fixedBits = 0;
 
   for (uint8_t bitOffset = 0; bitOffset < Nodes.size(); bitOffset++) {
-    if (auto step = path.findStepFromNode(Nodes.at(bitOffset))) {
+    if (Nodes[bitOffset].hasSingleChild())
+      continue;
+
+    if (auto step = path.findStepFromNode(Nodes[bitOffset])) {
       uint32_t bit = step->getSrcNodeEvalValue();
       uint32_t vectorBit = bit << bitOffset;
       fixedBits |= vectorBit;
@@ -31,39 +54,19 @@ uint32_t CGConditionVectorVariationsBuilder::buildFixedBitsTemplate(
   return fixedBits;
 }
 
-std::vector<uint8_t>
+CGConditionVectorVariationsBuilder::BitOffsets
 CGConditionVectorVariationsBuilder::collectVariableBitOffsets(
-    CGEvaluationPath path) const {
-  std::vector<uint8_t> variableBitOffsets;
+    const CGEvaluationPath &path) const {
+  BitOffsets variableBitOffsets;
 
+  // nodes with a single child continue there for both evaluations, so their
+  // bits don't matter even on the path
   for (uint8_t bitOffset = 0; bitOffset < Nodes.size(); bitOffset++) {
-    if (!path.hasNode(Nodes.at(bitOffset))) {
+    const DecisionTreeNode &node = Nodes[bitOffset];
+    if (!path.hasNode(node) || node.hasSingleChild()) {
       variableBitOffsets.push_back(bitOffset);
     }
   }
 
   return variableBitOffsets;
 }
-
-std::list<uint32_t>
-CGConditionVectorVariationsBuilder::buildVariantsRecursively(
-    uint32_t conditionVector, const std::vector<uint8_t> &variableBitOffsets,
-    uint8_t bitToVaryIdx) {
-  // if there is no more bit to vary, return assembled condition vector
-  if (bitToVaryIdx == variableBitOffsets.size())
-    return {conditionVector};
-
-  uint8_t bitToVaryOffset = variableBitOffsets.at(bitToVaryIdx);
-  assert(bitToVaryOffset < sizeof(uint32_t) * 8);
-
-  uint32_t vectorTrueBit = 1u << bitToVaryOffset;
-  assert((conditionVector & ~vectorTrueBit) == conditionVector);
-
-  std::list<uint32_t> falseVariations = buildVariantsRecursively(
-      conditionVector, variableBitOffsets, bitToVaryIdx + 1);
-
-  std::list<uint32_t> trueVariations = buildVariantsRecursively(
-      conditionVector | vectorTrueBit, variableBitOffsets, bitToVaryIdx + 1);
-
-  return concatLists(std::move(falseVariations), std::move(trueVariations));
-}
@@ -1,9 +1,10 @@
 #pragma once
 
 #include <cstdint>
-#include <list>
 #include <vector>
 
+#include <llvm/ADT/SmallVector.h>
+
 #include "codegen/utility/CGEvaluationPath.h"
 #include "data/DecisionSubtreeRef.h"
 
@@ -11,9 +12,9 @@ class CGConditionVectorVariationsBuilder {
 public:
   CGConditionVectorVariationsBuilder(DecisionSubtreeRef subtreeRef)
       : Subtree(std::move(subtreeRef)),
-        Nodes(moveToVector(Subtree.collectNodesPreOrder())) {}
+        Nodes(Subtree.collectNodesPreOrder()) {}
 
-  std::vector<uint32_t> run(CGEvaluationPath pathInfo);
+  std::vector<uint32_t> run(const CGEvaluationPath &pathInfo);
 
   uint32_t getBitOffsetForNode(DecisionTreeNode node) const {
     auto it = std::find(Nodes.begin(), Nodes.end(), node);
@@ -25,14 +26,11 @@ public:
   }
 
 private:
-  const DecisionSubtreeRef Subtree;
-  const std::vector<DecisionTreeNode> Nodes;
+  using BitOffsets = llvm::SmallVector<uint8_t, 16>;
 
-  uint32_t buildFixedBitsTemplate(CGEvaluationPath path) const;
-  std::vector<uint8_t> collectVariableBitOffsets(CGEvaluationPath path) const;
+  const DecisionSubtreeRef Subtree;
+  const DecisionSubtreeRef::NodeVector Nodes;
 
-  std::list<uint32_t>
-  buildVariantsRecursively(uint32_t conditionVector,
-                           const std::vector<uint8_t> &variableBitOffsets,
-                           uint8_t bitToVaryIdx);
+  uint32_t buildFixedBitsTemplate(const CGEvaluationPath &path) const;
+  BitOffsets collectVariableBitOffsets(const CGEvaluationPath &path) const;
 };
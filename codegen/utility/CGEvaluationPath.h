@@ -5,6 +5,8 @@
 
 #include <experimental/optional>
 
+#include <llvm/ADT/SmallVector.h>
+
 #include "data/DecisionSubtreeRef.h"
 #include "data/DecisionTreeNode.h"
 
@@ -51,7 +53,11 @@ struct CGEvaluationPath {
 
   CGEvaluationPath(DecisionSubtreeRef subtree,
                    DecisionTreeNode destinationNode)
-      : Steps(subtree.Levels), DestinationNode(destinationNode),
+      : CGEvaluationPath(subtree.Levels, destinationNode) {}
+
+  // paths to result nodes above the subtree's bottom level have less steps
+  CGEvaluationPath(uint8_t numSteps, DecisionTreeNode destinationNode)
+      : Steps(numSteps), DestinationNode(destinationNode),
         InsertIdx(Steps.size()) {}
 
   friend bool operator==(const CGEvaluationPath &lhs,
@@ -121,7 +127,8 @@ struct CGEvaluationPath {
     return Steps[idx];
   }
 
-  std::vector<CGEvaluationStep> Steps;
+  // at most one step per subtree level, so at most 4
+  llvm::SmallVector<CGEvaluationStep, 4> Steps;
 
 private:
   DecisionTreeNode DestinationNode;
@@ -2,46 +2,43 @@
 #include "Utils.h"
 
 std::vector<CGEvaluationPath> CGEvaluationPathsBuilder::run() {
-  std::list<CGEvaluationPath> paths =
-      buildPathsRecursively(Subtree.Root, Subtree.Levels);
+  std::vector<CGEvaluationPath> paths;
+  paths.reserve(Subtree.getContinuationNodeCount());
+
+  buildPathsRecursively(Subtree.Root, Subtree.Levels, paths);
 
   assert(paths.size() == Subtree.getContinuationNodeCount());
-  return moveToVector(std::move(paths));
+  return paths;
 }
 
-std::list<CGEvaluationPath>
-CGEvaluationPathsBuilder::buildPathsRecursively(DecisionTreeNode node,
-                                                uint8_t remainingLevels) {
-  // subtree continuation nodes insert a new path
-  if (node.isLeaf() || remainingLevels == 0)
-    return {CGEvaluationPath(Subtree, node)};
-
-  // subtree nodes add themselves to all child continuation node paths
-  std::list<CGEvaluationPath> paths;
-
-  paths.splice(paths.end(),
-               recurseToChildNode(NodeEvaluation::ContinueZeroLeft, node,
-                                  remainingLevels));
-
-  paths.splice(paths.end(),
-               recurseToChildNode(NodeEvaluation::ContinueOneRight, node,
-                                  remainingLevels));
-
-  return paths;
+void CGEvaluationPathsBuilder::buildPathsRecursively(
+    DecisionTreeNode node, uint8_t remainingLevels,
+    std::vector<CGEvaluationPath> &paths) {
+  // subtree continuation nodes insert a new path, result nodes can be
+  // continuation nodes on any level
+  if (node.isImplicit() || remainingLevels == 0) {
+    paths.emplace_back((uint8_t)(Subtree.Levels - remainingLevels), node);
+    return;
+  }
+
+  recurseToChildNode(NodeEvaluation::ContinueZeroLeft, node, remainingLevels,
+                     paths);
+
+  recurseToChildNode(NodeEvaluation::ContinueOneRight, node, remainingLevels,
+                     paths);
 }
 
-std::list<CGEvaluationPath>
-CGEvaluationPathsBuilder::recurseToChildNode(NodeEvaluation eval,
-                                             DecisionTreeNode node,
-                                             uint8_t remainingLevels) {
+void CGEvaluationPathsBuilder::recurseToChildNode(
+    NodeEvaluation eval, DecisionTreeNode node, uint8_t remainingLevels,
+    std::vector<CGEvaluationPath> &paths) {
   if (!node.hasChildFor(eval))
-    return {};
-
-  std::list<CGEvaluationPath> paths = buildPathsRecursively(
-      node.getChildFor(eval, Subtree), remainingLevels - 1);
+    return;
 
-  for (CGEvaluationPath &p : paths)
-    p.addParent(node, eval);
+  size_t firstChildPath = paths.size();
+  buildPathsRecursively(node.getChildFor(eval, Subtree), remainingLevels - 1,
+                        paths);
 
-  return paths;
+  // subtree nodes add themselves to all child continuation node paths
+  for (size_t i = firstChildPath; i < paths.size(); i++)
+    paths[i].addParent(node, eval);
 }
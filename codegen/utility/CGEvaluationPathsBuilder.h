@@ -1,6 +1,5 @@
 #pragma once
 
-#include <list>
 #include <vector>
 
 #include "codegen/utility/CGEvaluationPath.h"
@@ -16,10 +15,10 @@ public:
 private:
   DecisionSubtreeRef Subtree;
 
-  std::list<CGEvaluationPath> buildPathsRecursively(DecisionTreeNode node,
-                                                    uint8_t remainingLevels);
+  void buildPathsRecursively(DecisionTreeNode node, uint8_t remainingLevels,
+                             std::vector<CGEvaluationPath> &paths);
 
-  std::list<CGEvaluationPath> recurseToChildNode(NodeEvaluation eval,
-                                                 DecisionTreeNode node,
-                                                 uint8_t remainingLevels);
+  void recurseToChildNode(NodeEvaluation eval, DecisionTreeNode node,
+                          uint8_t remainingLevels,
+                          std::vector<CGEvaluationPath> &paths);
 };
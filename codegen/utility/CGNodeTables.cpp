@@ -0,0 +1,99 @@
+#include "codegen/utility/CGNodeTables.h"
+
+#include <limits>
+#include <vector>
+
+#include <llvm/IR/GlobalVariable.h>
+
+#include "compiler/CompilerSession.h"
+
+using namespace llvm;
+
+CGNodeTables::CGNodeTables(const CompilerSession &session)
+    : Session(session), Int32Ty(Type::getInt32Ty(session.Builder.getContext())) {
+  const DecisionTree &tree = *session.Tree;
+  uint64_t numSlots = tree.getNumNodeSlots();
+  assert(numSlots <= std::numeric_limits<uint32_t>::max());
+
+  std::vector<uint32_t> featureIdxs(numSlots, 0);
+  std::vector<float> biases(numSlots, std::numeric_limits<float>::infinity());
+  std::vector<uint32_t> leftChildSlots(numSlots);
+  std::vector<uint32_t> rightChildSlots(numSlots);
+
+  for (uint64_t slot = 0; slot < numSlots; slot++) {
+    leftChildSlots[slot] = rightChildSlots[slot] = slot;
+
+    if (!tree.isNodeSlotUsed(slot))
+      continue;
+
+    const DecisionTreeNode &node = tree.getNodeInSlot(slot);
+    if (node.isLeaf())
+      continue;
+
+    featureIdxs[slot] = node.getFeatureIdx();
+    biases[slot] = node.getFeatureBias();
+
+    uint64_t leftIdx = node.hasLeftChild() ? node.getLeftChildIdx()
+                                           : node.getRightChildIdx();
+    uint64_t rightIdx = node.hasRightChild() ? node.getRightChildIdx()
+                                             : node.getLeftChildIdx();
+
+    leftChildSlots[slot] = tree.getNodeSlot(leftIdx);
+    rightChildSlots[slot] = tree.getNodeSlot(rightIdx);
+  }
+
+  LLVMContext &ctx = session.Builder.getContext();
+  FeatureIdxs = emitTable(ConstantDataArray::get(ctx, featureIdxs), "featureIdxs");
+  Biases = emitTable(ConstantDataArray::get(ctx, biases), "biases");
+  LeftChildSlots = emitTable(ConstantDataArray::get(ctx, leftChildSlots), "leftChildSlots");
+  RightChildSlots = emitTable(ConstantDataArray::get(ctx, rightChildSlots), "rightChildSlots");
+
+  // without payloads the result is the node index, which only needs a table
+  // if it differs from the slot
+  if (tree.getLeafPayloadKind() != LeafPayloadKind::NodeIdx ||
+      !tree.usesNodeIdxAsSlot()) {
+    Type *resultTy = session.getResultTy();
+    std::vector<Constant *> results(numSlots, Constant::getNullValue(resultTy));
+
+    for (uint64_t slot = 0; slot < numSlots; slot++) {
+      if (tree.isNodeSlotUsed(slot) && tree.getNodeInSlot(slot).isImplicit())
+        results[slot] =
+            session.getResultConstant(tree.getNodeInSlot(slot).getIdx());
+    }
+
+    ArrayType *resultsTy = ArrayType::get(resultTy, numSlots);
+    Results = emitTable(ConstantArray::get(resultsTy, results), "results");
+  }
+}
+
+Value *CGNodeTables::emitLoadFeatureIdx(Value *slot) {
+  return emitLoadTableItem(FeatureIdxs, slot);
+}
+
+Value *CGNodeTables::emitLoadBias(Value *slot) {
+  return emitLoadTableItem(Biases, slot);
+}
+
+Value *CGNodeTables::emitLoadChildSlot(Value *slot, Value *cmpResult) {
+  Value *leftChildSlot = emitLoadTableItem(LeftChildSlots, slot);
+  Value *rightChildSlot = emitLoadTableItem(RightChildSlots, slot);
+  return Session.Builder.CreateSelect(cmpResult, rightChildSlot, leftChildSlot);
+}
+
+Value *CGNodeTables::emitLoadResult(Value *slot) {
+  if (Results == nullptr)
+    return Session.Builder.CreateZExt(slot, Session.getResultTy());
+
+  return emitLoadTableItem(Results, slot);
+}
+
+Constant *CGNodeTables::emitTable(Constant *init, std::string name) {
+  return new GlobalVariable(*Session.Module.get(), init->getType(), true,
+                            GlobalVariable::PrivateLinkage, init, name);
+}
+
+Value *CGNodeTables::emitLoadTableItem(Constant *table, Value *slot) {
+  Constant *ptrDeref = ConstantInt::get(slot->getType(), 0);
+  Value *itemPtr = Session.Builder.CreateInBoundsGEP(table, {ptrDeref, slot});
+  return Session.Builder.CreateLoad(itemPtr);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+#include <llvm/IR/Constant.h>
+#include <llvm/IR/Value.h>
+
+class CompilerSession;
+
+// Global constant arrays that describe the session's tree indexed by node
+// slot, see DecisionTree::getNodeSlot(). Evaluators that navigate the tree at
+// run-time use them instead of inlining the node data into the code. Walks
+// start at slot 0, the root, and children are loaded as slots too.
+//
+// Leaf nodes loop back to themselves and never compare greater than their
+// bias, so a walk may take more steps than the depth of the leaf it reaches.
+// Nodes with a single child continue to that child unconditionally.
+//
+// Result nodes map to their leaf payloads. If the tree has no payloads, the
+// result is the node index, which needs no table if it is the slot.
+class CGNodeTables {
+public:
+  CGNodeTables(const CompilerSession &session);
+
+  llvm::Value *emitLoadFeatureIdx(llvm::Value *slot);
+  llvm::Value *emitLoadBias(llvm::Value *slot);
+  llvm::Value *emitLoadChildSlot(llvm::Value *slot, llvm::Value *cmpResult);
+
+  // the leaf payload for a result node's slot
+  llvm::Value *emitLoadResult(llvm::Value *slot);
+
+  llvm::Type *getSlotTy() const { return Int32Ty; }
+
+  // for evaluators that access the tables with vector gathers
+  llvm::Constant *getFeatureIdxTable() const { return FeatureIdxs; }
+  llvm::Constant *getBiasTable() const { return Biases; }
+
+private:
+  const CompilerSession &Session;
+  llvm::Type *Int32Ty;
+
+  llvm::Constant *FeatureIdxs;
+  llvm::Constant *Biases;
+  llvm::Constant *LeftChildSlots;
+  llvm::Constant *RightChildSlots;
+  llvm::Constant *Results = nullptr; // if results differ from slots only
+
+  llvm::Constant *emitTable(llvm::Constant *init, std::string name);
+  llvm::Value *emitLoadTableItem(llvm::Constant *table, llvm::Value *slot);
+};
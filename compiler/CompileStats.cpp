@@ -0,0 +1,31 @@
+#include "compiler/CompileStats.h"
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+
+using namespace llvm;
+
+void CompileStats::add(const CompileStats &other) {
+  IREmission += other.IREmission;
+  PathBuilding += other.PathBuilding;
+  VariationBuilding += other.VariationBuilding;
+  Optimization += other.Optimization;
+  MachineCodeEmission += other.MachineCodeEmission;
+  Linking += other.Linking;
+
+  for (const auto &entry : other.CodegenEmission)
+    CodegenEmission[entry.first] += entry.second;
+
+  IRInstructions += other.IRInstructions;
+  OptimizedIRInstructions += other.OptimizedIRInstructions;
+  ObjectFileBytes += other.ObjectFileBytes;
+}
+
+uint64_t CompileStats::countInstructions(const Module &module) {
+  uint64_t count = 0;
+  for (const Function &function : module)
+    for (const BasicBlock &block : function)
+      count += block.size();
+
+  return count;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace llvm {
+class Module;
+}
+
+// Where the time of a tree's compilation goes and how much code it produced.
+// Frontend phases are recorded by DecisionTreeCompiler, backend phases by
+// SimpleOrcJit. For parallel compilation the times of all subtree modules are
+// summed up, so they may exceed the wall time. Modules from the object cache
+// only report linking.
+struct CompileStats {
+  using Duration_t = std::chrono::nanoseconds;
+
+  // all of DecisionTreeCompiler::compile(), including the phases below
+  Duration_t IREmission{0};
+
+  // subtree emission per code generator, including path and variation
+  // building, keyed by CodeGenerator::getName()
+  std::map<std::string, Duration_t> CodegenEmission;
+
+  // evaluation paths and condition vector variations for subtree switches
+  Duration_t PathBuilding{0};
+  Duration_t VariationBuilding{0};
+
+  Duration_t Optimization{0};
+  Duration_t MachineCodeEmission{0};
+  Duration_t Linking{0};
+
+  uint64_t IRInstructions = 0;          // before optimization
+  uint64_t OptimizedIRInstructions = 0;
+  uint64_t ObjectFileBytes = 0;
+
+  Duration_t getTotal() const {
+    return IREmission + Optimization + MachineCodeEmission + Linking;
+  }
+
+  void add(const CompileStats &other);
+
+  static uint64_t countInstructions(const llvm::Module &module);
+};
+
+// Adds the time from construction to destruction to the given duration.
+class CompileTimer {
+  using Clock_t = std::chrono::steady_clock;
+
+public:
+  CompileTimer(CompileStats::Duration_t &accumulator)
+      : Accumulator(accumulator), Start(Clock_t::now()) {}
+
+  ~CompileTimer() {
+    Accumulator += std::chrono::duration_cast<CompileStats::Duration_t>(
+        Clock_t::now() - Start);
+  }
+
+  CompileTimer(const CompileTimer &) = delete;
+  CompileTimer &operator=(const CompileTimer &) = delete;
+  CompileTimer(CompileTimer &&) = delete;
+  CompileTimer &operator=(CompileTimer &&) = delete;
+
+private:
+  CompileStats::Duration_t &Accumulator;
+  Clock_t::time_point Start;
+};
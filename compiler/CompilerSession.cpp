@@ -8,16 +8,75 @@ using namespace llvm;
 CompilerSession::CompilerSession(DecisionTreeCompiler *compiler,
                                  TargetMachine *targetMachine,
                                  std::string name)
-    : Builder(compiler->Ctx),
-      NodeIdxTy(Type::getInt64Ty(compiler->Ctx)),
-      DataSetFeatureValueTy(Type::getFloatTy(compiler->Ctx)) {
-  Module = std::make_unique<llvm::Module>("file:" + name, compiler->Ctx);
+    : CompilerSession(compiler->Ctx, targetMachine, std::move(name)) {}
+
+CompilerSession::CompilerSession(LLVMContext &ctx,
+                                 TargetMachine *targetMachine,
+                                 std::string name)
+    : Builder(ctx),
+      NodeIdxTy(Type::getInt64Ty(ctx)),
+      ScoreTy(Type::getFloatTy(ctx)),
+      DataSetFeatureValueTy(Type::getFloatTy(ctx)) {
+  Module = std::make_unique<llvm::Module>("file:" + name, ctx);
   Module->setDataLayout(targetMachine->createDataLayout());
+  SizeTy = Module->getDataLayout().getIntPtrType(ctx);
 }
 
 CompilerSession::~CompilerSession() = default;
 
+Type *CompilerSession::getResultTy() const {
+  switch (Tree->getLeafPayloadKind()) {
+    case LeafPayloadKind::NodeIdx: return NodeIdxTy;
+    case LeafPayloadKind::Score: return ScoreTy;
+    case LeafPayloadKind::ClassId: return NodeIdxTy;
+  }
+
+  llvm_unreachable("Unknown leaf payload kind");
+}
+
+Constant *CompilerSession::getResultConstant(uint64_t resultNodeIdx) const {
+  switch (Tree->getLeafPayloadKind()) {
+    case LeafPayloadKind::NodeIdx:
+      return ConstantInt::get(NodeIdxTy, resultNodeIdx);
+    case LeafPayloadKind::Score:
+      return ConstantFP::get(ScoreTy, Tree->getLeafScore(resultNodeIdx));
+    case LeafPayloadKind::ClassId:
+      return ConstantInt::get(NodeIdxTy, Tree->getLeafClassId(resultNodeIdx));
+  }
+
+  llvm_unreachable("Unknown leaf payload kind");
+}
+
 CodeGenerator *
 CompilerSession::selectCodeGenerator(uint8_t remainingLevels) const {
   return CodegenSelector->select(*this, remainingLevels);
 }
+
+BatchCodeGenerator *CompilerSession::selectBatchCodeGenerator() const {
+  return CodegenSelector->selectBatch(*this);
+}
+
+Value *CompilerSession::emitLoadFeatureValue(uint32_t featureIdx) const {
+  if (InputColumnStride == nullptr) {
+    Value *featurePtr = Builder.CreateConstGEP1_32(InputDataSetPtr, featureIdx);
+    return Builder.CreateLoad(featurePtr);
+  }
+
+  Constant *featureIdxVal = ConstantInt::get(SizeTy, featureIdx);
+  Value *offset = Builder.CreateMul(InputColumnStride, featureIdxVal);
+  return Builder.CreateLoad(Builder.CreateGEP(InputDataSetPtr, offset));
+}
+
+Value *CompilerSession::emitLoadBatchFeatureValue(Value *rowIdx,
+                                                  Value *featureIdx) const {
+  Value *featureIdxVal = Builder.CreateZExt(featureIdx, SizeTy);
+
+  Value *offset =
+      (Layout == DataSetLayout::RowMajor)
+          ? Builder.CreateAdd(Builder.CreateMul(rowIdx, BatchStride),
+                              featureIdxVal)
+          : Builder.CreateAdd(Builder.CreateMul(featureIdxVal, BatchStride),
+                              rowIdx);
+
+  return Builder.CreateLoad(Builder.CreateGEP(BatchDataPtr, offset));
+}
@@ -3,15 +3,20 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <llvm/IR/Function.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
 #include <llvm/Target/TargetMachine.h>
 
+#include "compiler/CompileStats.h"
+#include "compiler/DataSetLayout.h"
 #include "data/DecisionTree.h"
 
+class BatchCodeGenerator;
 class CodeGenerator;
 class CodeGeneratorSelector;
 class DecisionTreeCompiler;
@@ -29,19 +34,48 @@ struct CompilerSession final {
 
   CompilerSession(DecisionTreeCompiler *compiler,
                   llvm::TargetMachine *targetMachine, std::string name);
+
+  // emit into a context other than the compiler's
+  CompilerSession(llvm::LLVMContext &ctx, llvm::TargetMachine *targetMachine,
+                  std::string name);
   ~CompilerSession();
 
   mutable llvm::IRBuilder<> Builder;
 
-  DecisionTree Tree;
+  DecisionTreeHandle Tree;
   std::unique_ptr<llvm::Module> Module = nullptr;
 
+  // subtree evaluators for parallel compilation, each in its own context
+  std::vector<std::unique_ptr<llvm::LLVMContext>> SubtreeContexts;
+  std::vector<std::unique_ptr<llvm::Module>> SubtreeModules;
+
+  // code generators record their phases here
+  mutable CompileStats Stats;
+
   llvm::Type *NodeIdxTy;
+  llvm::Type *ScoreTy;
   llvm::Type *DataSetFeatureValueTy;
+  llvm::Type *SizeTy;
+
+  // evaluators return the leaf payload of the result node they reach
+  llvm::Type *getResultTy() const;
+  llvm::Constant *getResultConstant(uint64_t resultNodeIdx) const;
 
   llvm::Value *InputDataSetPtr;
-  llvm::Value *OutputNodeIdxPtr;
+  llvm::Value *InputColumnStride = nullptr; // column-major input only
+  llvm::Value *OutputResultPtr;
+
+  // batch evaluator arguments
+  DataSetLayout Layout = DataSetLayout::RowMajor;
+  llvm::Value *BatchDataPtr = nullptr;
+  llvm::Value *BatchStride = nullptr;
+  llvm::Value *BatchOutputPtr = nullptr;
 
   std::shared_ptr<CodeGeneratorSelector> CodegenSelector;
   CodeGenerator *selectCodeGenerator(uint8_t remainingLevels) const;
+  BatchCodeGenerator *selectBatchCodeGenerator() const;
+
+  llvm::Value *emitLoadFeatureValue(uint32_t featureIdx) const;
+  llvm::Value *emitLoadBatchFeatureValue(llvm::Value *rowIdx,
+                                         llvm::Value *featureIdx) const;
 };
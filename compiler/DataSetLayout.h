@@ -0,0 +1,6 @@
+#pragma once
+
+// Memory layout of the data-sets passed to the batch evaluator. Row-major
+// stores all features of one data-set contiguously, column-major stores the
+// values of one feature for all data-sets contiguously.
+enum class DataSetLayout { RowMajor, ColumnMajor };
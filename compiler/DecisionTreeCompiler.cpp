@@ -1,12 +1,16 @@
 #include "DecisionTreeCompiler.h"
 
 #include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/Twine.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Support/MD5.h>
 
+#include "codegen/BatchCodeGenerator.h"
 #include "codegen/CodeGenerator.h"
 #include "codegen/CodeGeneratorSelector.h"
 #include "compiler/CompilerSession.h"
+#include "compiler/ObjectFileCache.h"
 
 using namespace llvm;
 
@@ -15,124 +19,763 @@ DecisionTreeCompiler::DecisionTreeCompiler(TargetMachine *target)
   llvm::sys::getHostCPUFeatures(CpuFeatures);
 }
 
+void DecisionTreeCompiler::setDataSetLayout(DataSetLayout layout) {
+  Layout = layout;
+}
+
+void DecisionTreeCompiler::setTreesPerFunction(uint32_t trees) {
+  assert(trees > 0);
+  TreesPerFunction = trees;
+}
+
+void DecisionTreeCompiler::setParallelSplitLevel(uint8_t level) {
+  ParallelSplitLevel = level;
+}
+
+void DecisionTreeCompiler::setOptimizationLevel(OptimizationLevel level) {
+  OptLevel = level;
+}
+
+void DecisionTreeCompiler::setObjectCache(ObjectFileCache *cache) {
+  ObjectCache = cache;
+}
+
 void DecisionTreeCompiler::setCodegenSelector(
       std::shared_ptr<CodeGeneratorSelector> codegenSelector) {
   CodegenSelector = codegenSelector;
   CodegenSelector->AvxSupport = CpuFeatures["avx"];
+  CodegenSelector->Avx2Support = CpuFeatures["avx2"];
 }
 
 CompileResult DecisionTreeCompiler::compile(DecisionTree tree) {
+  return compile(makeTreeHandle(std::move(tree)));
+}
+
+// Payloads are set after finalize(), so a tree can only be checked for
+// missing ones when it gets compiled. Returns an error message or an empty
+// string.
+static std::string verifyLeafPayloads(const DecisionTree &tree) {
+  uint64_t resultIdx = tree.findResultWithoutPayload();
+  if (resultIdx == DecisionTreeNode::NoNodeIdx)
+    return std::string();
+
+  return ("Result node " + Twine(resultIdx) + " has no leaf payload").str();
+}
+
+CompileResult DecisionTreeCompiler::compile(DecisionTreeHandle tree) {
+  assert(tree && tree->isFinalized());
+
+  std::string error = verifyLeafPayloads(*tree);
+  if (!error.empty()) {
+    CompileResult result;
+    result.Tree = std::move(tree);
+    result.ErrorMessage = std::move(error);
+    return result;
+  }
+
   if (CodegenSelector == nullptr)
     setCodegenSelector(std::make_shared<DefaultSelector>());
 
+  std::string cacheKey = getCacheKey(*tree);
+  if (!cacheKey.empty() && ObjectCache->preload(cacheKey)) {
+    CompileResult result;
+    result.Tree = std::move(tree);
+    result.Module = std::make_unique<Module>(cacheKey, Ctx);
+    result.EvaluatorFunctionName = "EvaluatorFunction";
+    result.BatchEvaluatorFunctionName = "EvaluatorFunctionBatch";
+    result.Success = true;
+    result.FromObjectCache = true;
+    return result;
+  }
+
   CompilerSession session(this, Target, "sessionName");
   session.CodegenSelector = CodegenSelector;
   session.Tree = std::move(tree);
+  session.Layout = Layout;
+
+  if (!cacheKey.empty())
+    session.Module->setModuleIdentifier(cacheKey);
+
+  Function *evalFn;
+  Function *batchFn;
+  {
+    CompileTimer timer(session.Stats.IREmission);
+    evalFn = emitEvaluator("EvaluatorFunction", getEvalFunctionTy(session),
+                           session);
+
+    Function *batchRowFn = evalFn;
+    if (Layout == DataSetLayout::ColumnMajor) {
+      batchRowFn = emitEvaluator("EvaluatorFunctionColumnMajor",
+                                 getColumnMajorEvalFunctionTy(session),
+                                 session);
+      batchRowFn->setLinkage(Function::InternalLinkage);
+    }
+
+    // the batch evaluator calls into the single-row evaluator, which must be
+    // inlined so the tree body ends up in the loop without call overhead
+    batchRowFn->addFnAttr(Attribute::AlwaysInline);
+
+    batchFn = emitBatchEvaluator("EvaluatorFunctionBatch", batchRowFn, session);
+  }
+
+  session.Stats.IRInstructions =
+      CompileStats::countInstructions(*session.Module);
+  for (const std::unique_ptr<Module> &subtreeModule : session.SubtreeModules)
+    session.Stats.IRInstructions +=
+        CompileStats::countInstructions(*subtreeModule);
+
+  CompileResult result;
+  result.Tree = std::move(session.Tree);
+  result.Module = std::move(session.Module);
+  result.EvaluatorFunctionName = evalFn->getName();
+  result.BatchEvaluatorFunctionName = batchFn->getName();
+  result.SubtreeContexts = std::move(session.SubtreeContexts);
+  result.SubtreeModules = std::move(session.SubtreeModules);
+  result.Stats = std::move(session.Stats);
+  result.Success = !verifyFunction(*evalFn);
+
+  return result;
+}
+
+// uint64_t EvaluatorForest(float *dataSet) or
+// float EvaluatorForest(float *dataSet)
+//
+// Returns the sum of the results of all trees or, for trees with class id
+// payloads, the class with the most votes. Each tree is emitted as an
+// internal evaluator function that gets inlined into one of the internal
+// EvaluatorForestPart functions. The parts are not inlined, so the size of
+// the functions that go through the optimizer and the backend is bounded by
+// TreesPerFunction.
+ForestCompileResult
+DecisionTreeCompiler::compile(std::vector<DecisionTree> trees) {
+  std::vector<DecisionTreeHandle> handles;
+  handles.reserve(trees.size());
+
+  for (DecisionTree &tree : trees)
+    handles.push_back(makeTreeHandle(std::move(tree)));
+
+  return compile(std::move(handles));
+}
+
+// all trees need complete payloads of the same kind, as the forest
+// evaluator adds up or votes on their results
+static std::string
+verifyForestLeafPayloads(const std::vector<DecisionTreeHandle> &trees) {
+  LeafPayloadKind payloadKind = trees.front()->getLeafPayloadKind();
+
+  for (size_t i = 0; i < trees.size(); i++) {
+    if (trees[i]->getLeafPayloadKind() != payloadKind)
+      return ("Tree " + Twine(i) + " has a different kind of leaf payload")
+          .str();
+
+    std::string error = verifyLeafPayloads(*trees[i]);
+    if (!error.empty())
+      return ("Tree " + Twine(i) + ": " + error).str();
+  }
+
+  return std::string();
+}
+
+ForestCompileResult
+DecisionTreeCompiler::compile(std::vector<DecisionTreeHandle> trees) {
+  assert(!trees.empty());
+
+  std::string error = verifyForestLeafPayloads(trees);
+  if (!error.empty()) {
+    ForestCompileResult result;
+    result.Trees = std::move(trees);
+    result.ErrorMessage = std::move(error);
+    return result;
+  }
+
+  if (CodegenSelector == nullptr)
+    setCodegenSelector(std::make_shared<DefaultSelector>());
+
+  std::string cacheKey = getCacheKey(trees);
+  if (!cacheKey.empty() && ObjectCache->preload(cacheKey)) {
+    ForestCompileResult result;
+    result.Trees = std::move(trees);
+    result.Module = std::make_unique<Module>(cacheKey, Ctx);
+    result.EvaluatorFunctionName = "EvaluatorForest";
+    result.Success = true;
+    result.FromObjectCache = true;
+    return result;
+  }
+
+  CompilerSession session(this, Target, "sessionName");
+  session.CodegenSelector = CodegenSelector;
+
+  if (!cacheKey.empty())
+    session.Module->setModuleIdentifier(cacheKey);
+
+  LeafPayloadKind payloadKind = trees.front()->getLeafPayloadKind();
+  bool vote = (payloadKind == LeafPayloadKind::ClassId);
+  uint64_t numClasses = 0;
+
+  std::vector<Function *> partFns;
+  std::vector<Function *> treeFns;
+
+  ForestCompileResult result;
+  result.Trees.reserve(trees.size());
+
+  Function *forestFn;
+  {
+    CompileTimer timer(session.Stats.IREmission);
+
+    for (size_t i = 0; i < trees.size(); i++) {
+      session.Tree = std::move(trees[i]);
+
+      if (vote)
+        numClasses = std::max(numClasses, session.Tree->getNumClasses());
+
+      Function *treeFn = emitEvaluator(
+          "EvaluatorTree" + utostr(i), getEvalFunctionTy(session), session,
+          session.Tree->getRootNodeIdx(), session.Tree->getNumLevels());
+      treeFn->setLinkage(Function::InternalLinkage);
+      treeFn->addFnAttr(Attribute::AlwaysInline);
+      treeFns.push_back(treeFn);
+
+      result.Trees.push_back(std::move(session.Tree));
+
+      if (treeFns.size() == TreesPerFunction || i + 1 == trees.size()) {
+        std::string partName = "EvaluatorForestPart" + utostr(partFns.size());
+        Function *partFn = vote ? emitVotePart(partName, treeFns, session)
+                                : emitSumEvaluator(partName, treeFns, session);
+        partFn->setLinkage(Function::InternalLinkage);
+        partFn->addFnAttr(Attribute::NoInline);
+        partFns.push_back(partFn);
+        treeFns.clear();
+      }
+    }
+
+    forestFn = vote ? emitVoteEvaluator("EvaluatorForest", partFns,
+                                        numClasses, session)
+                    : emitSumEvaluator("EvaluatorForest", partFns, session);
+  }
+
+  session.Stats.IRInstructions =
+      CompileStats::countInstructions(*session.Module);
+  result.Stats = std::move(session.Stats);
+
+  result.Module = std::move(session.Module);
+  result.EvaluatorFunctionName = forestFn->getName();
+  result.Success = !verifyFunction(*forestFn);
+
+  return result;
+}
+
+Function *
+DecisionTreeCompiler::emitSumEvaluator(std::string functionName,
+                                       const std::vector<Function *> &callees,
+                                       const CompilerSession &session) {
+  Type *resultTy = callees.front()->getReturnType();
+  Type *dataSetTy = session.DataSetFeatureValueTy->getPointerTo();
+  FunctionType *signature = FunctionType::get(resultTy, {dataSetTy}, false);
+
+  Module *module = session.Module.get();
+  Function *fn = emitEvalFunctionDecl(functionName, signature, module);
+
+  IRBuilder<> &builder = session.Builder;
+  builder.SetInsertPoint(BasicBlock::Create(Ctx, "entry", fn));
+
+  Value *dataSetPtr = &*fn->arg_begin();
+  Value *sum = Constant::getNullValue(resultTy);
+
+  for (Function *callee : callees) {
+    Value *treeResult = builder.CreateCall(callee, {dataSetPtr});
+    sum = resultTy->isFloatingPointTy() ? builder.CreateFAdd(sum, treeResult)
+                                        : builder.CreateAdd(sum, treeResult);
+  }
+
+  builder.CreateRet(sum);
+  return fn;
+}
+
+// void EvaluatorForestPart(float *dataSet, uint64_t *votes)
+//
+// Increments the vote counter of each tree's class.
+Function *
+DecisionTreeCompiler::emitVotePart(std::string functionName,
+                                   const std::vector<Function *> &callees,
+                                   const CompilerSession &session) {
+  Type *dataSetTy = session.DataSetFeatureValueTy->getPointerTo();
+  Type *votesTy = session.NodeIdxTy->getPointerTo();
+  FunctionType *signature =
+      FunctionType::get(Type::getVoidTy(Ctx), {dataSetTy, votesTy}, false);
+
+  Module *module = session.Module.get();
+  Function *fn = emitEvalFunctionDecl(functionName, signature, module);
+
+  IRBuilder<> &builder = session.Builder;
+  builder.SetInsertPoint(BasicBlock::Create(Ctx, "entry", fn));
+
+  auto argIt = fn->arg_begin();
+  Value *dataSetPtr = &*argIt++;
+  Value *votesPtr = &*argIt;
+  Constant *one = ConstantInt::get(session.NodeIdxTy, 1);
+
+  for (Function *callee : callees) {
+    Value *classId = builder.CreateCall(callee, {dataSetPtr});
+    Value *counterPtr = builder.CreateGEP(votesPtr, classId);
+    builder.CreateStore(builder.CreateAdd(builder.CreateLoad(counterPtr), one),
+                        counterPtr);
+  }
+
+  builder.CreateRetVoid();
+  return fn;
+}
+
+// uint64_t EvaluatorForest(float *dataSet)
+//
+// Collects the votes of all parts and returns the class with the most votes.
+// Ties go to the smaller class id.
+Function *
+DecisionTreeCompiler::emitVoteEvaluator(std::string functionName,
+                                        const std::vector<Function *> &parts,
+                                        uint64_t numClasses,
+                                        const CompilerSession &session) {
+  assert(numClasses > 0);
+  Type *dataSetTy = session.DataSetFeatureValueTy->getPointerTo();
+  FunctionType *signature =
+      FunctionType::get(session.NodeIdxTy, {dataSetTy}, false);
+
+  Module *module = session.Module.get();
+  Function *fn = emitEvalFunctionDecl(functionName, signature, module);
 
-  CGNodeInfo root = makeEvalRoot("EvaluatorFunction", session);
+  IRBuilder<> &builder = session.Builder;
+  builder.SetInsertPoint(BasicBlock::Create(Ctx, "entry", fn));
+
+  Value *dataSetPtr = &*fn->arg_begin();
+  Value *numClassesVal = ConstantInt::get(session.SizeTy, numClasses);
+  Value *votesPtr =
+      builder.CreateAlloca(session.NodeIdxTy, numClassesVal, "votes");
+
+  uint64_t counterBytes = session.NodeIdxTy->getPrimitiveSizeInBits() / 8;
+  builder.CreateMemSet(votesPtr, builder.getInt8(0), numClasses * counterBytes,
+                       counterBytes);
+
+  for (Function *part : parts)
+    builder.CreateCall(part, {dataSetPtr, votesPtr});
+
+  Value *bestClass = ConstantInt::get(session.NodeIdxTy, 0);
+  Value *bestVotes = builder.CreateLoad(votesPtr);
+
+  for (uint64_t classId = 1; classId < numClasses; classId++) {
+    Value *votesPtrForClass = builder.CreateConstGEP1_64(votesPtr, classId);
+    Value *votes = builder.CreateLoad(votesPtrForClass);
+    Value *isBetter = builder.CreateICmpUGT(votes, bestVotes);
+
+    Constant *classIdVal = ConstantInt::get(session.NodeIdxTy, classId);
+    bestClass = builder.CreateSelect(isBetter, classIdVal, bestClass);
+    bestVotes = builder.CreateSelect(isBetter, votes, bestVotes);
+  }
+
+  builder.CreateRet(bestClass);
+  return fn;
+}
+
+Function *DecisionTreeCompiler::emitEvaluator(std::string functionName,
+                                              FunctionType *signature,
+                                              CompilerSession &session) {
+  uint8_t levels = session.Tree->getNumLevels();
+  if (ParallelSplitLevel > 0 && ParallelSplitLevel < levels)
+    levels = ParallelSplitLevel;
+
+  return emitEvaluator(std::move(functionName), signature, session,
+                       session.Tree->getRootNodeIdx(), levels);
+}
+
+// Evaluates the given number of levels below rootIdx. If the levels don't
+// reach the result nodes, the evaluator calls separate subtree evaluators
+// for the remaining levels.
+Function *DecisionTreeCompiler::emitEvaluator(std::string functionName,
+                                              FunctionType *signature,
+                                              CompilerSession &session,
+                                              uint64_t rootIdx,
+                                              uint8_t levels) {
+  CGNodeInfo root =
+      makeEvalRoot(std::move(functionName), signature, rootIdx, session);
+  Function *fn = root.OwnerFunction;
 
   session.Builder.SetInsertPoint(root.EvalBlock);
-  session.OutputNodeIdxPtr = allocOutputVal(session);
-  session.InputDataSetPtr = &*root.OwnerFunction->arg_begin();
+  session.OutputResultPtr = allocOutputVal(session);
+
+  // column-major evaluators receive the column stride as second argument
+  auto argIt = fn->arg_begin();
+  session.InputDataSetPtr = &*argIt++;
+  session.InputColumnStride = (argIt != fn->arg_end()) ? &*argIt : nullptr;
+
+  std::vector<CGNodeInfo> leafNodes = compileSubtrees(root, levels, session);
+
+  uint8_t rootLevel = DecisionTree::getLevelForNodeIdx(rootIdx);
+  if (rootLevel + levels < session.Tree->getNumLevels())
+    emitSubtreeModules(fn, leafNodes, session);
 
-  std::vector<CGNodeInfo> leafNodes = compileSubtrees(root, session);
   connectSubtreeEndpoints(std::move(leafNodes), session);
 
   session.Builder.SetInsertPoint(root.ContinuationBlock);
   session.Builder.CreateRet(
-      session.Builder.CreateLoad(session.OutputNodeIdxPtr));
+      session.Builder.CreateLoad(session.OutputResultPtr));
 
-  CompileResult result;
-  result.Tree = std::move(session.Tree);
-  result.Module = std::move(session.Module);
-  result.EvaluatorFunctionName = root.OwnerFunction->getName();
-  result.Success = verifyFunction(*root.OwnerFunction);
+  return fn;
+}
 
-  return result;
+static std::string getSubtreeFunctionName(StringRef callerName,
+                                          uint64_t subtreeRootIdx) {
+  return callerName.str() + "Subtree" + utostr(subtreeRootIdx);
+}
+
+// Emits an evaluator for each of the subtrees into a new context and module.
+// The evaluators have the same signature as the caller and external linkage,
+// so the JIT can link the modules once it compiled them in parallel. The
+// subtree sessions share the tree.
+void DecisionTreeCompiler::emitSubtreeModules(
+    Function *caller, const std::vector<CGNodeInfo> &subtreeRoots,
+    CompilerSession &session) {
+  bool columnMajor = (caller->arg_size() == 2);
+
+  for (const CGNodeInfo &node : subtreeRoots) {
+    if (session.Tree->getNode(node.Index).isImplicit())
+      continue;
+
+    session.SubtreeContexts.push_back(std::make_unique<LLVMContext>());
+    LLVMContext &ctx = *session.SubtreeContexts.back();
+
+    std::string name = getSubtreeFunctionName(caller->getName(), node.Index);
+    CompilerSession subtreeSession(ctx, Target, name);
+    subtreeSession.CodegenSelector = session.CodegenSelector;
+    subtreeSession.Layout = session.Layout;
+    subtreeSession.Tree = session.Tree;
+
+    FunctionType *signature =
+        columnMajor ? getColumnMajorEvalFunctionTy(subtreeSession)
+                    : getEvalFunctionTy(subtreeSession);
+
+    uint8_t levels = subtreeSession.Tree->getNumLevels() -
+                     DecisionTree::getLevelForNodeIdx(node.Index);
+
+    emitEvaluator(name, signature, subtreeSession, node.Index, levels);
+
+    session.SubtreeModules.push_back(std::move(subtreeSession.Module));
+    session.Stats.add(subtreeSession.Stats);
+  }
+}
+
+Value *DecisionTreeCompiler::emitSubtreeCall(CGNodeInfo subtreeRoot,
+                                             const CompilerSession &session) {
+  Function *caller = subtreeRoot.OwnerFunction;
+  Function *callee = emitEvalFunctionDecl(
+      getSubtreeFunctionName(caller->getName(), subtreeRoot.Index),
+      caller->getFunctionType(), session.Module.get());
+
+  std::vector<Value *> args;
+  for (Argument &arg : caller->args())
+    args.push_back(&arg);
+
+  return session.Builder.CreateCall(callee, args);
 }
 
 CGNodeInfo DecisionTreeCompiler::makeEvalRoot(std::string functionName,
+                                              FunctionType *signature,
+                                              uint64_t rootIdx,
                                               const CompilerSession &session) {
   CGNodeInfo root;
-  root.Index = session.Tree.getRootNodeIdx();
+  root.Index = rootIdx;
 
   Module *module = session.Module.get();
-  FunctionType *ty = getEvalFunctionTy(session);
-  Function *fn = emitEvalFunctionDecl(functionName, ty, module);
+  Function *fn = emitEvalFunctionDecl(functionName, signature, module);
 
+  LLVMContext &ctx = module->getContext();
   root.OwnerFunction = fn;
-  root.EvalBlock = BasicBlock::Create(Ctx, "entry", fn);
-  root.ContinuationBlock = BasicBlock::Create(Ctx, "exit", fn);
+  root.EvalBlock = BasicBlock::Create(ctx, "entry", fn);
+  root.ContinuationBlock = BasicBlock::Create(ctx, "exit", fn);
 
   return root;
 }
 
 FunctionType *
 DecisionTreeCompiler::getEvalFunctionTy(const CompilerSession &session) {
-  Type *returnTy = session.NodeIdxTy;
+  Type *returnTy = session.getResultTy();
   Type *argTy = session.DataSetFeatureValueTy->getPointerTo();
   return FunctionType::get(returnTy, {argTy}, false);
 }
 
+FunctionType *DecisionTreeCompiler::getColumnMajorEvalFunctionTy(
+    const CompilerSession &session) {
+  Type *returnTy = session.getResultTy();
+  Type *argTy = session.DataSetFeatureValueTy->getPointerTo();
+  return FunctionType::get(returnTy, {argTy, session.SizeTy}, false);
+}
+
+FunctionType *
+DecisionTreeCompiler::getBatchEvalFunctionTy(const CompilerSession &session) {
+  Type *returnTy = Type::getVoidTy(Ctx);
+  Type *rowsTy = session.DataSetFeatureValueTy->getPointerTo();
+  Type *outTy = session.getResultTy()->getPointerTo();
+  return FunctionType::get(
+      returnTy, {rowsTy, session.SizeTy, session.SizeTy, outTy}, false);
+}
+
 Function *DecisionTreeCompiler::emitEvalFunctionDecl(std::string name,
                                                      FunctionType *signature,
                                                      Module *module) {
   Function *evalFn =
       Function::Create(signature, Function::ExternalLinkage, name, module);
 
-  evalFn->setAttributes(collectEvalFunctionAttribs());
+  evalFn->setAttributes(collectEvalFunctionAttribs(module->getContext()));
   evalFn->setName(name);
   return evalFn;
 }
 
-AttributeSet DecisionTreeCompiler::collectEvalFunctionAttribs() {
+AttributeSet DecisionTreeCompiler::collectEvalFunctionAttribs(LLVMContext &ctx) {
+  std::string features = getTargetFeatures();
+
+  AttributeSet attributeSet;
+  if (features.empty())
+    return attributeSet;
+
+  return attributeSet.addAttribute(ctx, AttributeSet::FunctionIndex,
+                                   "target-features", features);
+}
+
+std::string DecisionTreeCompiler::getTargetFeatures() const {
   std::vector<std::string> features;
   for (const StringMapEntry<bool> &feature : CpuFeatures) {
     if (feature.getValue())
       features.emplace_back("+" + feature.getKey().str());
   }
 
-  AttributeSet attributeSet;
-  if (features.empty())
-    return attributeSet;
-
   std::sort(features.begin(), features.end());
-  return attributeSet.addAttribute(
-      Ctx, AttributeSet::FunctionIndex, "target-features",
-      join(features.begin(), features.end(), ","));
+  return join(features.begin(), features.end(), ",");
+}
+
+static std::string makeCacheKey(MD5 &hasher) {
+  MD5::MD5Result digest;
+  hasher.final(digest);
+
+  SmallString<32> hexDigest;
+  MD5::stringifyResult(digest, hexDigest);
+  return ObjectFileCache::makeCacheKey(hexDigest);
+}
+
+// empty if there is no object cache or the selector doesn't support caching
+std::string DecisionTreeCompiler::getCacheKey(const DecisionTree &tree) const {
+  MD5 hasher;
+  if (!addConfigToHash(hasher))
+    return std::string{};
+
+  tree.addToHash(hasher);
+  return makeCacheKey(hasher);
+}
+
+std::string DecisionTreeCompiler::getCacheKey(
+    const std::vector<DecisionTreeHandle> &trees) const {
+  MD5 hasher;
+  if (!addConfigToHash(hasher))
+    return std::string{};
+
+  uint64_t counts[] = {TreesPerFunction, trees.size()};
+  hasher.update(ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(counts),
+                                  sizeof(counts)));
+
+  for (const DecisionTreeHandle &tree : trees)
+    tree->addToHash(hasher);
+
+  return makeCacheKey(hasher);
+}
+
+bool DecisionTreeCompiler::addConfigToHash(MD5 &hasher) const {
+  // split trees are linked from multiple objects, which the compile layer's
+  // cache can't handle
+  if (ObjectCache == nullptr || ParallelSplitLevel > 0)
+    return false;
+
+  std::string selectorKey = CodegenSelector->getCacheKey();
+  if (selectorKey.empty())
+    return false;
+
+  std::string triple = Target->getTargetTriple().str();
+  std::string cpu = Target->getTargetCPU().str();
+  std::string features = getTargetFeatures();
+
+  // zero-terminate each string, so different splits can't collide
+  const uint8_t terminator = 0;
+  for (const std::string *str : {&selectorKey, &triple, &cpu, &features}) {
+    hasher.update(*str);
+    hasher.update(makeArrayRef(terminator));
+  }
+
+  const uint8_t layout = static_cast<uint8_t>(Layout);
+  hasher.update(makeArrayRef(layout));
+
+  const uint8_t optLevel = static_cast<uint8_t>(OptLevel);
+  hasher.update(makeArrayRef(optLevel));
+  return true;
+}
+
+// void EvaluatorFunctionBatch(float *data, size_t stride, size_t numRows,
+//                             uint64_t *out)
+//
+// Evaluates numRows data-sets and writes the results to out. The stride is
+// given in number of floats. For row-major data it's the distance between
+// the first features of two rows, for column-major data it's the distance
+// between the values of two features for a single row.
+//
+// If the selector provides a batch code generator, it evaluates the rows in
+// blocks of getRowsPerIteration(). Remaining rows are evaluated one by one.
+Function *
+DecisionTreeCompiler::emitBatchEvaluator(std::string functionName,
+                                         Function *evalFunction,
+                                         CompilerSession &session) {
+  Module *module = session.Module.get();
+  FunctionType *ty = getBatchEvalFunctionTy(session);
+  Function *fn = emitEvalFunctionDecl(functionName, ty, module);
+
+  auto argIt = fn->arg_begin();
+  Value *dataPtr = &*argIt++;
+  Value *stride = &*argIt++;
+  Value *numRows = &*argIt++;
+  Value *outputPtr = &*argIt;
+
+  session.BatchDataPtr = dataPtr;
+  session.BatchStride = stride;
+  session.BatchOutputPtr = outputPtr;
+
+  IRBuilder<> &builder = session.Builder;
+  Constant *zero = ConstantInt::get(session.SizeTy, 0);
+  Constant *one = ConstantInt::get(session.SizeTy, 1);
+
+  BasicBlock *entryBB = BasicBlock::Create(Ctx, "entry", fn);
+  builder.SetInsertPoint(entryBB);
+
+  Value *firstRowIdx = zero;
+  if (BatchCodeGenerator *codegen = session.selectBatchCodeGenerator())
+    firstRowIdx = emitBlockedRowsLoop(codegen, fn, numRows, session);
+
+  BasicBlock *tailEntryBB = builder.GetInsertBlock();
+  BasicBlock *loopBB = BasicBlock::Create(Ctx, "loop", fn);
+  BasicBlock *exitBB = BasicBlock::Create(Ctx, "exit", fn);
+
+  Value *noRowsLeft = builder.CreateICmpEQ(firstRowIdx, numRows);
+  builder.CreateCondBr(noRowsLeft, exitBB, loopBB);
+
+  builder.SetInsertPoint(loopBB);
+  PHINode *rowIdx = builder.CreatePHI(session.SizeTy, 2, "rowIdx");
+  rowIdx->addIncoming(firstRowIdx, tailEntryBB);
+
+  Value *result;
+  if (Layout == DataSetLayout::RowMajor) {
+    Value *rowOffset = builder.CreateMul(rowIdx, stride);
+    Value *rowPtr = builder.CreateGEP(dataPtr, rowOffset);
+    result = builder.CreateCall(evalFunction, {rowPtr});
+  } else {
+    Value *firstFeaturePtr = builder.CreateGEP(dataPtr, rowIdx);
+    result = builder.CreateCall(evalFunction, {firstFeaturePtr, stride});
+  }
+  builder.CreateStore(result, builder.CreateGEP(outputPtr, rowIdx));
+
+  Value *nextRowIdx = builder.CreateAdd(rowIdx, one);
+  rowIdx->addIncoming(nextRowIdx, loopBB);
+
+  Value *done = builder.CreateICmpEQ(nextRowIdx, numRows);
+  builder.CreateCondBr(done, exitBB, loopBB);
+
+  builder.SetInsertPoint(exitBB);
+  builder.CreateRetVoid();
+
+  return fn;
+}
+
+// Emits a loop over all complete blocks of rows and returns the index of the
+// first row that was not evaluated. Leaves the builder in the block after the
+// loop.
+Value *DecisionTreeCompiler::emitBlockedRowsLoop(BatchCodeGenerator *codegen,
+                                                 Function *fn, Value *numRows,
+                                                 const CompilerSession &session) {
+  IRBuilder<> &builder = session.Builder;
+  BasicBlock *entryBB = builder.GetInsertBlock();
+  BasicBlock *loopBB = BasicBlock::Create(Ctx, "blocks_loop", fn);
+  BasicBlock *loopEndBB = BasicBlock::Create(Ctx, "blocks_loop_end", fn);
+  BasicBlock *doneBB = BasicBlock::Create(Ctx, "blocks_done", fn);
+
+  Constant *zero = ConstantInt::get(session.SizeTy, 0);
+  Constant *rowsPerIteration =
+      ConstantInt::get(session.SizeTy, codegen->getRowsPerIteration());
+
+  Value *numBlocks = builder.CreateUDiv(numRows, rowsPerIteration);
+  Value *numBlockedRows = builder.CreateMul(numBlocks, rowsPerIteration);
+
+  Value *noBlocks = builder.CreateICmpEQ(numBlockedRows, zero);
+  builder.CreateCondBr(noBlocks, doneBB, loopBB);
+
+  builder.SetInsertPoint(loopBB);
+  PHINode *firstRowIdx = builder.CreatePHI(session.SizeTy, 2, "firstRowIdx");
+  firstRowIdx->addIncoming(zero, entryBB);
+
+  {
+    CompileTimer timer(session.Stats.CodegenEmission[codegen->getName()]);
+    codegen->emitBatchEvaluation(
+        session, CGBatchInfo(firstRowIdx, fn, loopBB, loopEndBB));
+  }
+
+  builder.SetInsertPoint(loopEndBB);
+  Value *nextRowIdx = builder.CreateAdd(firstRowIdx, rowsPerIteration);
+  firstRowIdx->addIncoming(nextRowIdx, loopEndBB);
+
+  Value *done = builder.CreateICmpEQ(nextRowIdx, numBlockedRows);
+  builder.CreateCondBr(done, doneBB, loopBB);
+
+  builder.SetInsertPoint(doneBB);
+  return numBlockedRows;
 }
 
 Value *DecisionTreeCompiler::allocOutputVal(const CompilerSession &session) {
-  Value *ptr =
-      session.Builder.CreateAlloca(session.NodeIdxTy, nullptr, "result");
+  Type *resultTy = session.getResultTy();
+  Value *ptr = session.Builder.CreateAlloca(resultTy, nullptr, "result");
 
-  Constant *initVal = ConstantInt::get(session.NodeIdxTy, 0);
+  Constant *initVal = Constant::getNullValue(resultTy);
   session.Builder.CreateStore(initVal, ptr);
   return ptr;
 }
 
 std::vector<CGNodeInfo>
-DecisionTreeCompiler::compileSubtrees(CGNodeInfo rootNode,
+DecisionTreeCompiler::compileSubtrees(CGNodeInfo rootNode, uint8_t levels,
                                       const CompilerSession &session) {
   std::vector<CGNodeInfo> nodesNextLevel = {rootNode};
-  uint8_t remainingLevels = session.Tree.getNumLevels();
+  std::vector<CGNodeInfo> endpoints;
+  uint8_t remainingLevels = levels;
+
+  // endpoints above the result nodes are connected to subtree evaluators
+  uint8_t rootLevel = DecisionTree::getLevelForNodeIdx(rootNode.Index);
+  bool reachesResults = (rootLevel + levels == session.Tree->getNumLevels());
 
   while (remainingLevels > 0) {
     CodeGenerator *codegen = session.selectCodeGenerator(remainingLevels);
     bool isLeafSubtree = (remainingLevels == codegen->getJointSubtreeDepth());
+    assert(codegen->getJointSubtreeDepth() <= remainingLevels);
+
+    // in unbalanced trees, result nodes can show up on any level
+    std::vector<CGNodeInfo> roots;
+    for (CGNodeInfo &node : nodesNextLevel) {
+      if (session.Tree->getNode(node.Index).isImplicit())
+        endpoints.push_back(std::move(node));
+      else
+        roots.push_back(std::move(node));
+    }
 
-    std::vector<CGNodeInfo> roots = std::move(nodesNextLevel);
-
-    if (isLeafSubtree && codegen->canEmitLeafEvaluation()) {
+    if (reachesResults && isLeafSubtree && codegen->canEmitLeafEvaluation()) {
       compileLeafSubtrees(codegen, std::move(roots), session);
-      return {}; // endpoints connected already
+      return endpoints; // only results above the leaf subtrees left
     }
 
     nodesNextLevel = compileNestedSubtrees(codegen, std::move(roots), session);
     remainingLevels -= codegen->getJointSubtreeDepth();
   }
 
-  return nodesNextLevel; // unconnected endpoints
+  // unconnected endpoints
+  std::move(nodesNextLevel.begin(), nodesNextLevel.end(),
+            std::back_inserter(endpoints));
+  return endpoints;
 }
 
 std::vector<CGNodeInfo>
@@ -140,6 +783,7 @@ DecisionTreeCompiler::compileNestedSubtrees(CodeGenerator *codegen,
                                             std::vector<CGNodeInfo> roots,
                                             const CompilerSession &session) {
   std::vector<CGNodeInfo> levelContinuationNodes;
+  CompileTimer timer(session.Stats.CodegenEmission[codegen->getName()]);
 
   for (CGNodeInfo node : roots) {
     std::vector<CGNodeInfo> subtreeContinuationNodes =
@@ -155,12 +799,14 @@ DecisionTreeCompiler::compileNestedSubtrees(CodeGenerator *codegen,
 void DecisionTreeCompiler::compileLeafSubtrees(CodeGenerator *codegen,
                                                std::vector<CGNodeInfo> roots,
                                                const CompilerSession &session) {
+  CompileTimer timer(session.Stats.CodegenEmission[codegen->getName()]);
+
   for (CGNodeInfo node : roots) {
     session.Builder.SetInsertPoint(node.EvalBlock);
 
-    Value *nodeIdxVal = codegen->emitLeafEvaluation(session, node);
+    Value *resultVal = codegen->emitLeafEvaluation(session, node);
 
-    session.Builder.CreateStore(nodeIdxVal, session.OutputNodeIdxPtr);
+    session.Builder.CreateStore(resultVal, session.OutputResultPtr);
     session.Builder.CreateBr(node.ContinuationBlock);
   }
 }
@@ -171,8 +817,11 @@ void DecisionTreeCompiler::connectSubtreeEndpoints(
   for (CGNodeInfo node : evaluatorEndPoints) {
     session.Builder.SetInsertPoint(node.EvalBlock);
 
-    Constant *nodeIdxVal = ConstantInt::get(session.NodeIdxTy, node.Index);
-    session.Builder.CreateStore(nodeIdxVal, session.OutputNodeIdxPtr);
+    Value *resultVal = session.Tree->getNode(node.Index).isImplicit()
+                           ? session.getResultConstant(node.Index)
+                           : emitSubtreeCall(node, session);
+
+    session.Builder.CreateStore(resultVal, session.OutputResultPtr);
     session.Builder.CreateBr(node.ContinuationBlock);
   }
 }
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <llvm/ADT/StringMap.h>
 #include <llvm/IR/Function.h>
@@ -12,17 +13,51 @@
 #include <llvm/Target/TargetMachine.h>
 
 #include "codegen/utility/CGNodeInfo.h"
+#include "compiler/CompileStats.h"
+#include "compiler/DataSetLayout.h"
+#include "compiler/OptimizationLevel.h"
 #include "data/DecisionTree.h"
 
+class BatchCodeGenerator;
 class CodeGenerator;
 class CodeGeneratorSelector;
 class CompilerSession;
+class ObjectFileCache;
+
+namespace llvm {
+class MD5;
+}
 
 struct CompileResult {
-  DecisionTree Tree;
+  DecisionTreeHandle Tree;
+  std::unique_ptr<llvm::Module> Module;
+  std::string EvaluatorFunctionName;
+  std::string BatchEvaluatorFunctionName;
+
+  // true if the evaluator passed the IR verifier or comes from the cache,
+  // Module is nullptr if the tree was rejected before emitting IR
+  bool Success = false;
+  std::string ErrorMessage;
+
+  // subtree evaluators called from Module, see setParallelSplitLevel()
+  std::vector<std::unique_ptr<llvm::LLVMContext>> SubtreeContexts;
+  std::vector<std::unique_ptr<llvm::Module>> SubtreeModules;
+
+  // Module is empty and its object is waiting in the object cache
+  bool FromObjectCache = false;
+
+  // frontend phases and IR size, the JIT adds the backend phases
+  CompileStats Stats;
+};
+
+struct ForestCompileResult {
+  std::vector<DecisionTreeHandle> Trees;
   std::unique_ptr<llvm::Module> Module;
   std::string EvaluatorFunctionName;
-  bool Success;
+  bool Success = false;
+  std::string ErrorMessage;
+  bool FromObjectCache = false;
+  CompileStats Stats;
 };
 
 class DecisionTreeCompiler {
@@ -34,10 +69,32 @@ public:
   void setCodegenSelector(
       std::shared_ptr<CodeGeneratorSelector> codegenSelector);
 
+  void setDataSetLayout(DataSetLayout layout);
+
+  // forests are split into internal functions with this many trees each
+  void setTreesPerFunction(uint32_t trees);
+
+  // cut trees at the given level and emit each subtree below it into a
+  // separate context and module, so the backend can optimize and compile
+  // them in parallel (0 disables splitting, forests are never split)
+  void setParallelSplitLevel(uint8_t level);
+
+  // the backend's pipeline, only affects object cache keys
+  void setOptimizationLevel(OptimizationLevel level);
+
+  // with an object cache, compile() skips code generation for trees that
+  // were compiled before with the same configuration on the same host
+  void setObjectCache(ObjectFileCache *cache);
+
   CompileResult compile(DecisionTree tree);
+  ForestCompileResult compile(std::vector<DecisionTree> trees);
+
+  // shared trees are not copied, the results keep a reference
+  CompileResult compile(DecisionTreeHandle tree);
+  ForestCompileResult compile(std::vector<DecisionTreeHandle> trees);
 
 private:
-  std::vector<CGNodeInfo> compileSubtrees(CGNodeInfo rootNode,
+  std::vector<CGNodeInfo> compileSubtrees(CGNodeInfo rootNode, uint8_t levels,
                                           const CompilerSession &session);
 
   std::vector<CGNodeInfo> compileNestedSubtrees(CodeGenerator *codegen,
@@ -51,15 +108,61 @@ private:
   void connectSubtreeEndpoints(std::vector<CGNodeInfo> evaluatorEndPoints,
                                const CompilerSession &session);
 
+  llvm::Function *emitEvaluator(std::string functionName,
+                                llvm::FunctionType *signature,
+                                CompilerSession &session);
+
+  llvm::Function *emitEvaluator(std::string functionName,
+                                llvm::FunctionType *signature,
+                                CompilerSession &session, uint64_t rootIdx,
+                                uint8_t levels);
+
+  void emitSubtreeModules(llvm::Function *caller,
+                          const std::vector<CGNodeInfo> &subtreeRoots,
+                          CompilerSession &session);
+
+  llvm::Value *emitSubtreeCall(CGNodeInfo subtreeRoot,
+                               const CompilerSession &session);
+
   CGNodeInfo makeEvalRoot(std::string functionName,
+                          llvm::FunctionType *signature, uint64_t rootIdx,
                           const CompilerSession &session);
 
+  llvm::Function *emitBatchEvaluator(std::string functionName,
+                                     llvm::Function *evalFunction,
+                                     CompilerSession &session);
+
+  llvm::Function *emitSumEvaluator(std::string functionName,
+                                   const std::vector<llvm::Function *> &callees,
+                                   const CompilerSession &session);
+
+  llvm::Function *emitVotePart(std::string functionName,
+                               const std::vector<llvm::Function *> &callees,
+                               const CompilerSession &session);
+
+  llvm::Function *emitVoteEvaluator(std::string functionName,
+                                    const std::vector<llvm::Function *> &parts,
+                                    uint64_t numClasses,
+                                    const CompilerSession &session);
+
+  llvm::Value *emitBlockedRowsLoop(BatchCodeGenerator *codegen,
+                                   llvm::Function *fn, llvm::Value *numRows,
+                                   const CompilerSession &session);
+
   llvm::Function *emitEvalFunctionDecl(std::string name,
                                        llvm::FunctionType *signature,
                                        llvm::Module *module);
 
   llvm::FunctionType *getEvalFunctionTy(const CompilerSession &session);
-  llvm::AttributeSet collectEvalFunctionAttribs();
+  llvm::FunctionType *
+  getColumnMajorEvalFunctionTy(const CompilerSession &session);
+  llvm::FunctionType *getBatchEvalFunctionTy(const CompilerSession &session);
+  llvm::AttributeSet collectEvalFunctionAttribs(llvm::LLVMContext &ctx);
+  std::string getTargetFeatures() const;
+
+  std::string getCacheKey(const DecisionTree &tree) const;
+  std::string getCacheKey(const std::vector<DecisionTreeHandle> &trees) const;
+  bool addConfigToHash(llvm::MD5 &hasher) const;
 
   llvm::Value *allocOutputVal(const CompilerSession &session);
 
@@ -67,4 +170,9 @@ private:
   llvm::TargetMachine *Target;
   llvm::StringMap<bool> CpuFeatures;
   std::shared_ptr<CodeGeneratorSelector> CodegenSelector;
+  DataSetLayout Layout = DataSetLayout::RowMajor;
+  uint32_t TreesPerFunction = 50;
+  uint8_t ParallelSplitLevel = 0;
+  OptimizationLevel OptLevel = OptimizationLevel::Max;
+  ObjectFileCache *ObjectCache = nullptr;
 };
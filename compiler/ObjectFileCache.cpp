@@ -0,0 +1,89 @@
+#include "compiler/ObjectFileCache.h"
+
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace llvm;
+
+// bump whenever the code generators change in a way that makes objects
+// from older versions incompatible
+static constexpr const char *CacheKeyPrefix = "EvalTreeJit-v1-";
+
+ObjectFileCache::ObjectFileCache(std::string cacheDir)
+    : CacheDir(std::move(cacheDir)) {
+  std::error_code EC = sys::fs::create_directories(CacheDir);
+  assert(!EC);
+}
+
+std::string ObjectFileCache::makeCacheKey(StringRef hexDigest) {
+  return CacheKeyPrefix + hexDigest.str();
+}
+
+bool ObjectFileCache::isCacheKey(StringRef moduleId) {
+  return moduleId.startswith(CacheKeyPrefix);
+}
+
+std::string ObjectFileCache::getObjectFileName(StringRef key) const {
+  return CacheDir + "/" + key.str() + ".o";
+}
+
+void ObjectFileCache::clear() {
+  std::error_code EC;
+  for (sys::fs::directory_iterator it(CacheDir, EC), end; it != end && !EC;
+       it.increment(EC)) {
+    StringRef fileName = sys::path::filename(it->path());
+    if (isCacheKey(fileName))
+      sys::fs::remove(it->path());
+  }
+}
+
+bool ObjectFileCache::preload(const std::string &key) {
+  assert(isCacheKey(key));
+  auto buffer = MemoryBuffer::getFile(getObjectFileName(key), -1, false);
+  if (!buffer)
+    return false;
+
+  std::lock_guard<std::mutex> lock(PreloadedMutex);
+  Preloaded[key] = std::move(*buffer);
+  return true;
+}
+
+void ObjectFileCache::notifyObjectCompiled(const Module *module,
+                                           MemoryBufferRef object) {
+  StringRef key = module->getModuleIdentifier();
+  if (!isCacheKey(key))
+    return;
+
+  // write to a unique temporary file and rename it, so concurrent processes
+  // never see partially written objects
+  int fd;
+  SmallString<256> tempFileName;
+  if (sys::fs::createUniqueFile(CacheDir + "/" + key.str() + "-%%%%%%.tmp", fd,
+                                tempFileName))
+    return;
+
+  raw_fd_ostream os(fd, true);
+  os.write(object.getBufferStart(), object.getBufferSize());
+  os.close();
+
+  if (os.has_error()) {
+    os.clear_error();
+    sys::fs::remove(tempFileName.str());
+    return;
+  }
+
+  if (sys::fs::rename(tempFileName.str(), getObjectFileName(key)))
+    sys::fs::remove(tempFileName.str());
+}
+
+std::unique_ptr<MemoryBuffer> ObjectFileCache::getObject(const Module *module) {
+  std::lock_guard<std::mutex> lock(PreloadedMutex);
+  auto it = Preloaded.find(module->getModuleIdentifier());
+  if (it == Preloaded.end())
+    return nullptr;
+
+  std::unique_ptr<MemoryBuffer> buffer = std::move(it->second);
+  Preloaded.erase(it);
+  return buffer;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+// Stores compiled objects as <CacheDir>/<key>.o, where the key is the
+// identifier of the module they were compiled from. Only modules with
+// identifiers from makeCacheKey() are stored.
+//
+// Cached objects are only served after preload() found them. This way the
+// compiler can check for a hit before it emits any IR and the compile layer
+// never falls back to compiling the empty module it gets in that case.
+class ObjectFileCache : public llvm::ObjectCache {
+public:
+  ObjectFileCache(std::string cacheDir);
+
+  ObjectFileCache(const ObjectFileCache &) = delete;
+  ObjectFileCache &operator=(const ObjectFileCache &) = delete;
+  ObjectFileCache(ObjectFileCache &&) = delete;
+  ObjectFileCache &operator=(ObjectFileCache &&) = delete;
+
+  // hexDigest is the MD5 over all inputs that affect the generated code
+  static std::string makeCacheKey(llvm::StringRef hexDigest);
+  static bool isCacheKey(llvm::StringRef moduleId);
+
+  // removes all cached objects from the cache directory
+  void clear();
+
+  // loads the object for the key into memory, false if there is none
+  bool preload(const std::string &key);
+
+  void notifyObjectCompiled(const llvm::Module *module,
+                            llvm::MemoryBufferRef object) override;
+
+  std::unique_ptr<llvm::MemoryBuffer>
+  getObject(const llvm::Module *module) override;
+
+private:
+  std::string CacheDir;
+  std::mutex PreloadedMutex;
+  llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> Preloaded;
+
+  std::string getObjectFileName(llvm::StringRef key) const;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+// Optimization pipelines for the JIT, trading compile time for evaluation
+// speed:
+//
+// Fast: Inline the evaluators into the batch loops and promote the result
+// variables to registers, nothing else. Instructions are selected with
+// FastISel and no verifier runs. Compiles deep trees several times faster
+// than Max, but the code keeps its redundant loads and compares.
+//
+// Balanced: The regular -O2 pipeline with SLP vectorization and the default
+// code generator level, without verifiers. Skips basic block vectorization,
+// which is slow on the large straight-line bodies of deep trees.
+//
+// Max: The pipeline the JIT always used: -O2 with basic block and SLP
+// vectorization, verifiers before and after optimization and the default
+// code generator level. This is the default.
+enum class OptimizationLevel { Fast, Balanced, Max };
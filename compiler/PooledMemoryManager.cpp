@@ -0,0 +1,160 @@
+#include "compiler/PooledMemoryManager.h"
+
+#include <cassert>
+
+#include <sys/mman.h>
+
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/Memory.h>
+
+using namespace llvm;
+
+CodeMemoryPool::~CodeMemoryPool() {
+  for (Arena *arena : {&Code, &Data})
+    for (const auto &region : arena->Regions)
+      munmap(region.first, region.second);
+}
+
+uint8_t *CodeMemoryPool::allocate(size_t size, unsigned alignment,
+                                  bool executable) {
+  std::lock_guard<std::mutex> lock(Mutex);
+  return allocateFrom(executable ? Code : Data, size, alignment, executable);
+}
+
+size_t CodeMemoryPool::getNumRegions() const {
+  std::lock_guard<std::mutex> lock(Mutex);
+  return Code.Regions.size() + Data.Regions.size();
+}
+
+// First fit in address order, so the sections of subsequent modules end up
+// next to each other.
+uint8_t *CodeMemoryPool::allocateFrom(Arena &arena, size_t size,
+                                      unsigned alignment, bool executable) {
+  assert(isPowerOf2_32(alignment));
+
+  auto fits = [&](const std::pair<uint8_t *const, size_t> &block) {
+    uintptr_t start = alignTo((uintptr_t)block.first, alignment);
+    return start + size <= (uintptr_t)block.first + block.second;
+  };
+
+  auto it = arena.FreeBlocks.begin();
+  while (it != arena.FreeBlocks.end() && !fits(*it))
+    ++it;
+
+  if (it == arena.FreeBlocks.end()) {
+    size_t regionSize = alignTo(size + alignment, RegionSize);
+    uint8_t *region = mapRegion(regionSize, executable);
+    arena.Regions.emplace_back(region, regionSize);
+    it = arena.FreeBlocks.emplace(region, regionSize).first;
+  }
+
+  uint8_t *blockStart = it->first;
+  uint8_t *blockEnd = it->first + it->second;
+  auto *start = (uint8_t *)alignTo((uintptr_t)blockStart, alignment);
+  uint8_t *end = start + size;
+
+  arena.FreeBlocks.erase(it);
+  if (start > blockStart)
+    arena.FreeBlocks.emplace(blockStart, start - blockStart);
+  if (blockEnd > end)
+    arena.FreeBlocks.emplace(end, blockEnd - end);
+
+  return start;
+}
+
+void CodeMemoryPool::release(uint8_t *ptr, size_t size, bool executable) {
+  if (size == 0)
+    return;
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  std::map<uint8_t *, size_t> &freeBlocks =
+      (executable ? Code : Data).FreeBlocks;
+
+  auto it = freeBlocks.emplace(ptr, size).first;
+
+  // merge with the following block
+  auto next = std::next(it);
+  if (next != freeBlocks.end() && it->first + it->second == next->first) {
+    it->second += next->second;
+    freeBlocks.erase(next);
+  }
+
+  // merge with the preceding block
+  if (it != freeBlocks.begin()) {
+    auto prev = std::prev(it);
+    if (prev->first + prev->second == it->first) {
+      prev->second += it->second;
+      freeBlocks.erase(it);
+    }
+  }
+}
+
+uint8_t *CodeMemoryPool::mapRegion(size_t size, bool executable) {
+  int prot = PROT_READ | PROT_WRITE | (executable ? PROT_EXEC : 0);
+
+  // map one extra region and unmap what is outside the aligned range
+  size_t mappedSize = size + RegionSize;
+  void *mem = mmap(nullptr, mappedSize, prot, MAP_PRIVATE | MAP_ANON, -1, 0);
+  if (mem == MAP_FAILED)
+    report_fatal_error("Failed to map JIT memory region");
+
+  auto begin = (uintptr_t)mem;
+  uintptr_t alignedBegin = alignTo(begin, RegionSize);
+  uintptr_t alignedEnd = alignedBegin + size;
+  uintptr_t end = begin + mappedSize;
+
+  if (alignedBegin > begin)
+    munmap(mem, alignedBegin - begin);
+  if (end > alignedEnd)
+    munmap((void *)alignedEnd, end - alignedEnd);
+
+#ifdef MADV_HUGEPAGE
+  madvise((void *)alignedBegin, size, MADV_HUGEPAGE);
+#endif
+
+  return (uint8_t *)alignedBegin;
+}
+
+PooledMemoryManager::~PooledMemoryManager() {
+  for (const Allocation &allocation : Allocations)
+    Pool->release(allocation.Ptr, allocation.Size, allocation.Executable);
+}
+
+uint8_t *PooledMemoryManager::allocate(uintptr_t size, unsigned alignment,
+                                       bool executable) {
+  if (alignment == 0)
+    alignment = 16;
+
+  uint8_t *ptr = Pool->allocate(size, alignment, executable);
+  Allocations.push_back({ptr, size, executable});
+  return ptr;
+}
+
+uint8_t *PooledMemoryManager::allocateCodeSection(uintptr_t size,
+                                                  unsigned alignment,
+                                                  unsigned sectionID,
+                                                  StringRef sectionName) {
+  uint8_t *ptr = allocate(size, alignment, true);
+  UnfinalizedCode.push_back(Allocations.back());
+  return ptr;
+}
+
+uint8_t *PooledMemoryManager::allocateDataSection(uintptr_t size,
+                                                  unsigned alignment,
+                                                  unsigned sectionID,
+                                                  StringRef sectionName,
+                                                  bool isReadOnly) {
+  // read-only data goes next to the code that uses it
+  return allocate(size, alignment, isReadOnly);
+}
+
+// The pool's regions keep their protection, only the instruction cache needs
+// to learn about the new code.
+bool PooledMemoryManager::finalizeMemory(std::string *errMsg) {
+  for (const Allocation &code : UnfinalizedCode)
+    sys::Memory::InvalidateInstructionCache(code.Ptr, code.Size);
+
+  UnfinalizedCode.clear();
+  return false;
+}
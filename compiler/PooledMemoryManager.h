@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ExecutionEngine/RTDyldMemoryManager.h>
+
+// Hands out memory for the sections of all modules of one or more JITs from
+// a few large regions, so the evaluators of many models share pages and iTLB
+// entries instead of each getting its own mappings. Regions are aligned to
+// 2MB and, on Linux, advised to be backed by transparent huge pages.
+//
+// Code and read-only data, like switch tables, are allocated side by side
+// from regions that are readable, writable and executable, because a huge
+// page can only have one protection. This gives up W^X for the JIT'ed code.
+// Writable data goes to separate regions, so stores never hit code lines.
+class CodeMemoryPool {
+public:
+  constexpr static size_t RegionSize = 2 * 1024 * 1024;
+
+  CodeMemoryPool() = default;
+  ~CodeMemoryPool();
+
+  CodeMemoryPool(CodeMemoryPool &&) = delete;
+  CodeMemoryPool(const CodeMemoryPool &) = delete;
+  CodeMemoryPool &operator=(CodeMemoryPool &&) = delete;
+  CodeMemoryPool &operator=(const CodeMemoryPool &) = delete;
+
+  // executable memory is also used for read-only data
+  uint8_t *allocate(size_t size, unsigned alignment, bool executable);
+  void release(uint8_t *ptr, size_t size, bool executable);
+
+  size_t getNumRegions() const;
+
+private:
+  struct Arena {
+    std::vector<std::pair<uint8_t *, size_t>> Regions;
+    std::map<uint8_t *, size_t> FreeBlocks; // start -> size, coalesced
+  };
+
+  mutable std::mutex Mutex;
+  Arena Code;
+  Arena Data;
+
+  static uint8_t *allocateFrom(Arena &arena, size_t size, unsigned alignment,
+                               bool executable);
+  static uint8_t *mapRegion(size_t size, bool executable);
+};
+
+// Memory manager for a single module that allocates its sections from a
+// shared pool and returns them once the module is removed from the JIT.
+class PooledMemoryManager : public llvm::RTDyldMemoryManager {
+public:
+  PooledMemoryManager(std::shared_ptr<CodeMemoryPool> pool)
+      : Pool(std::move(pool)) {}
+
+  ~PooledMemoryManager() override;
+
+  uint8_t *allocateCodeSection(uintptr_t size, unsigned alignment,
+                               unsigned sectionID,
+                               llvm::StringRef sectionName) override;
+
+  uint8_t *allocateDataSection(uintptr_t size, unsigned alignment,
+                               unsigned sectionID, llvm::StringRef sectionName,
+                               bool isReadOnly) override;
+
+  bool finalizeMemory(std::string *errMsg = nullptr) override;
+
+private:
+  struct Allocation {
+    uint8_t *Ptr;
+    size_t Size;
+    bool Executable;
+  };
+
+  std::shared_ptr<CodeMemoryPool> Pool;
+  std::vector<Allocation> Allocations;
+  std::vector<Allocation> UnfinalizedCode;
+
+  uint8_t *allocate(uintptr_t size, unsigned alignment, bool executable);
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <llvm/ExecutionEngine/Orc/IndirectionUtils.h>
+#include <llvm/ExecutionEngine/Orc/OrcABISupport.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/Memory.h>
+#include <llvm/Support/Process.h>
+
+// Same trampolines as LLVM's LocalJITCompileCallbackManager, but thread-safe
+// for concurrent first calls:
+// * Trampolines re-enter under the given mutex. The base class' trampoline
+//   map is not thread-safe in LLVM 3.9.
+// * Trampolines stay active after their compile action ran, until they are
+//   released explicitly. A thread that entered a trampoline while another
+//   one compiled its target runs the compile action again once it gets the
+//   mutex, so the action must return the existing code in that case. In
+//   LLVM's manager it would find no callback and jump to the error handler.
+//
+// Callers must hold the mutex for getCompileCallback() and
+// releaseCompileCallback() too.
+template <typename TargetABI_t>
+class SerializedCompileCallbackManager
+    : public llvm::orc::JITCompileCallbackManager {
+public:
+  SerializedCompileCallbackManager(std::mutex &mutex,
+                                   llvm::orc::TargetAddress errorHandler)
+      : JITCompileCallbackManager(errorHandler), Mutex(mutex) {
+    using namespace llvm::sys;
+
+    std::error_code EC;
+    ResolverBlock = OwningMemoryBlock(Memory::allocateMappedMemory(
+        TargetABI_t::ResolverCodeSize, nullptr,
+        Memory::MF_READ | Memory::MF_WRITE, EC));
+
+    if (EC)
+      llvm::report_fatal_error("Failed to allocate resolver block");
+
+    TargetABI_t::writeResolverCode(
+        static_cast<uint8_t *>(ResolverBlock.base()), &reenter, this);
+
+    EC = Memory::protectMappedMemory(ResolverBlock.getMemoryBlock(),
+                                     Memory::MF_READ | Memory::MF_EXEC);
+    if (EC)
+      llvm::report_fatal_error("Failed to protect resolver block");
+  }
+
+private:
+  std::mutex &Mutex;
+  llvm::sys::OwningMemoryBlock ResolverBlock;
+  std::vector<llvm::sys::OwningMemoryBlock> TrampolineBlocks;
+
+  static llvm::orc::TargetAddress reenter(void *manager, void *trampolineId) {
+    auto *self = static_cast<SerializedCompileCallbackManager *>(manager);
+    auto trampolineAddr = static_cast<llvm::orc::TargetAddress>(
+        reinterpret_cast<uintptr_t>(trampolineId));
+
+    std::lock_guard<std::mutex> lock(self->Mutex);
+    auto it = self->ActiveTrampolines.find(trampolineAddr);
+    if (it == self->ActiveTrampolines.end())
+      return self->ErrorHandlerAddress;
+
+    if (llvm::orc::TargetAddress addr = it->second())
+      return addr;
+
+    return self->ErrorHandlerAddress;
+  }
+
+  void grow() override {
+    using namespace llvm::sys;
+    assert(AvailableTrampolines.empty() && "Growing prematurely?");
+
+    std::error_code EC;
+    OwningMemoryBlock trampolineBlock(Memory::allocateMappedMemory(
+        Process::getPageSize(), nullptr, Memory::MF_READ | Memory::MF_WRITE,
+        EC));
+
+    if (EC)
+      llvm::report_fatal_error("Failed to allocate trampoline block");
+
+    unsigned numTrampolines =
+        (Process::getPageSize() - TargetABI_t::PointerSize) /
+        TargetABI_t::TrampolineSize;
+
+    auto *trampolineMem = static_cast<uint8_t *>(trampolineBlock.base());
+    TargetABI_t::writeTrampolines(trampolineMem, ResolverBlock.base(),
+                                  numTrampolines);
+
+    for (unsigned i = 0; i < numTrampolines; i++)
+      AvailableTrampolines.push_back(static_cast<llvm::orc::TargetAddress>(
+          reinterpret_cast<uintptr_t>(trampolineMem +
+                                      i * TargetABI_t::TrampolineSize)));
+
+    EC = Memory::protectMappedMemory(trampolineBlock.getMemoryBlock(),
+                                     Memory::MF_READ | Memory::MF_EXEC);
+    if (EC)
+      llvm::report_fatal_error("Failed to protect trampoline block");
+
+    TrampolineBlocks.push_back(std::move(trampolineBlock));
+  }
+};
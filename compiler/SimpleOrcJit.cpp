@@ -1,5 +1,9 @@
 #include "compiler/SimpleOrcJit.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
 #include <llvm/ExecutionEngine/RuntimeDyld.h>
 #include <llvm/ExecutionEngine/RTDyldMemoryManager.h>
 #include <llvm/ExecutionEngine/SectionMemoryManager.h>
@@ -7,25 +11,37 @@
 #include <llvm/IR/Function.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Mangler.h>
+#include <llvm/Object/ObjectFile.h>
 #include <llvm/Support/DynamicLibrary.h>
-#include <llvm/Transforms/Scalar.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Transforms/IPO.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
+#include <llvm/Transforms/Scalar.h>
 
-using namespace llvm;
+#include "compiler/SerializedCompileCallbackManager.h"
 
-std::mutex SimpleOrcJit::SubmitModuleMutex;
+using namespace llvm;
 
 SimpleOrcJit::SimpleOrcJit(TargetMachine *targetMachine)
-  : ObjectLayer(),
-    CompileLayer(ObjectLayer, orc::SimpleCompiler(*targetMachine)),
+  : TM(targetMachine),
+    ObjectLayer(),
+    CompileLayer(ObjectLayer,
+                 [this, compile = orc::SimpleCompiler(*targetMachine)](
+                     Module &M) {
+                   return compileModule(compile, M, SubmitStats);
+                 }),
     OptimizeLayer(
         CompileLayer,
-        [this](ModulePtr_t M) { return optimizeModule(std::move(M)); }),
+        [this](ModulePtr_t M) {
+          return optimizeModule(std::move(M), OptLevel, SubmitStats);
+        }),
     TargetDataLayout(targetMachine->createDataLayout()) {
   sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+  setOptimizationLevel(OptLevel);
 }
 
 orc::TargetAddress SimpleOrcJit::getFnAddress(std::string unmangledName) {
+  std::lock_guard<std::mutex> lock(SubmitModuleMutex);
   auto jitSymbol = CompileLayer.findSymbol(mangle(unmangledName), false);
   assert(jitSymbol.getAddress() != 0);
   return jitSymbol.getAddress();
@@ -33,6 +49,7 @@ orc::TargetAddress SimpleOrcJit::getFnAddress(std::string unmangledName) {
 
 orc::TargetAddress SimpleOrcJit::getFnAddressIn(ModuleHandle_t module,
                                                 std::string unmangledName) {
+  std::lock_guard<std::mutex> lock(SubmitModuleMutex);
   auto jitSymbol = CompileLayer.findSymbolIn(module, mangle(unmangledName), false);
   assert(jitSymbol.getAddress() != 0);
   return jitSymbol.getAddress();
@@ -47,12 +64,75 @@ auto SimpleOrcJit::mangle(std::string name) -> std::string {
   return mangledName;
 }
 
-auto SimpleOrcJit::optimizeModule(ModulePtr_t module) -> ModulePtr_t {
+void SimpleOrcJit::setOptimizationLevel(OptimizationLevel level) {
+  std::lock_guard<std::mutex> lock(SubmitModuleMutex);
+  OptLevel = level;
+
+  // the compile layer and the parallel compile workers use these settings
+  switch (level) {
+    case OptimizationLevel::Fast:
+      TM->setOptLevel(CodeGenOpt::None);
+      TM->setFastISel(true);
+      break;
+    case OptimizationLevel::Balanced:
+    case OptimizationLevel::Max:
+      TM->setOptLevel(CodeGenOpt::Default);
+      TM->setFastISel(false);
+      break;
+  }
+}
+
+auto SimpleOrcJit::compileModule(const orc::SimpleCompiler &compile,
+                                 Module &module, CompileStats *stats)
+    -> Object_t {
+  if (!stats)
+    return compile(module);
+
+  Object_t object;
+  {
+    CompileTimer timer(stats->MachineCodeEmission);
+    object = compile(module);
+  }
+
+  if (object.getBinary())
+    stats->ObjectFileBytes += object.getBinary()->getData().size();
+
+  return object;
+}
+
+auto SimpleOrcJit::optimizeModule(ModulePtr_t module, OptimizationLevel level,
+                                  CompileStats *stats) -> ModulePtr_t {
+  if (!stats)
+    return optimizeModule(std::move(module), level);
+
+  {
+    CompileTimer timer(stats->Optimization);
+    module = optimizeModule(std::move(module), level);
+  }
+
+  stats->OptimizedIRInstructions += CompileStats::countInstructions(*module);
+  return module;
+}
+
+auto SimpleOrcJit::optimizeModule(ModulePtr_t module, OptimizationLevel level)
+    -> ModulePtr_t {
+  if (level == OptimizationLevel::Fast) {
+    legacy::PassManager passes;
+    passes.add(createAlwaysInlinerPass());
+    passes.add(createPromoteMemoryToRegisterPass());
+    passes.run(*module);
+    return module;
+  }
+
+  bool max = (level == OptimizationLevel::Max);
+
+  // both use the builder's default -O2
   PassManagerBuilder PMBuilder;
-  PMBuilder.BBVectorize = true;
+  PMBuilder.BBVectorize = max;
   PMBuilder.SLPVectorize = true;
-  PMBuilder.VerifyInput = true;
-  PMBuilder.VerifyOutput = true;
+  PMBuilder.VerifyInput = max;
+  PMBuilder.VerifyOutput = max;
+  PMBuilder.Inliner = createAlwaysInlinerPass();
 
   legacy::FunctionPassManager perFunctionPasses(module.get());
   PMBuilder.populateFunctionPassManager(perFunctionPasses);
@@ -85,7 +165,9 @@ namespace {
   template <class OrcLayer_t>
   class DefaultLinkingResolver : public RuntimeDyld::SymbolResolver {
   public:
-    DefaultLinkingResolver(OrcLayer_t &orcLayer) : OrcLayer(orcLayer) {}
+    DefaultLinkingResolver(OrcLayer_t &orcLayer,
+                           orc::IndirectStubsManager *stubs = nullptr)
+        : OrcLayer(orcLayer), Stubs(stubs) {}
 
     RuntimeDyld::SymbolInfo findSymbol(const std::string &name) override {
       if (auto Sym = findMangledSymbol(name))
@@ -102,9 +184,15 @@ namespace {
 
   private:
     OrcLayer_t &OrcLayer;
+    orc::IndirectStubsManager *Stubs;
 
     orc::JITSymbol findMangledSymbol(const std::string &name) {
-      // local symbols first
+      // stubs of lazily compiled modules first
+      if (Stubs)
+        if (auto symbol = Stubs->findStub(name, false))
+          return symbol;
+
+      // local symbols next
       if (auto symbol = OrcLayer.findSymbol(name, false))
         return symbol;
 
@@ -118,27 +206,252 @@ namespace {
 }
 
 template <class OrcLayer_t>
-auto makeLinkingResolver(OrcLayer_t &orcLayer) {
-  return std::make_unique<DefaultLinkingResolver<OrcLayer_t>>(orcLayer);
+auto makeLinkingResolver(OrcLayer_t &orcLayer,
+                         orc::IndirectStubsManager *stubs = nullptr) {
+  return std::make_unique<DefaultLinkingResolver<OrcLayer_t>>(orcLayer, stubs);
 }
 
-auto makeMemoryManager() {
+auto SimpleOrcJit::makeMemoryManager()
+    -> std::unique_ptr<RuntimeDyld::MemoryManager> {
+  if (CodePool)
+    return std::make_unique<PooledMemoryManager>(CodePool);
+
   return std::make_unique<SectionMemoryManager>();
 }
 
+void SimpleOrcJit::setCodeMemoryPool(std::shared_ptr<CodeMemoryPool> pool) {
+  std::lock_guard<std::mutex> lock(SubmitModuleMutex);
+  CodePool = std::move(pool);
+}
+
 template <class T> auto makeModuleSet(T t) {
   std::vector<T> vec;
   vec.push_back(std::move(t));
   return vec;
 }
 
-auto SimpleOrcJit::submitModule(ModulePtr_t module) -> ModuleHandle_t {
+// Linking is the only phase that happens in emitAndFinalize(), the layers
+// optimize and compile in addModuleSet() already.
+template <class OrcLayer_t, class Handle_t>
+static void emitAndFinalize(OrcLayer_t &layer, Handle_t handle,
+                            CompileStats *stats) {
+  if (!stats) {
+    layer.emitAndFinalize(handle);
+    return;
+  }
+
+  CompileTimer timer(stats->Linking);
+  layer.emitAndFinalize(handle);
+}
+
+auto SimpleOrcJit::submitModule(ModulePtr_t module, CompileStats *stats)
+    -> ModuleHandle_t {
   std::lock_guard<std::mutex> lock(SubmitModuleMutex);
+  SubmitStats = stats;
 
   ModuleHandle_t handle = OptimizeLayer.addModuleSet(
       makeModuleSet(std::move(module)), makeMemoryManager(),
       makeLinkingResolver(OptimizeLayer));
 
-  OptimizeLayer.emitAndFinalize(handle);
+  SubmitStats = nullptr;
+  emitAndFinalize(OptimizeLayer, handle, stats);
+  return handle;
+}
+
+// Removing a module set invalidates its handle, so the lazy modules that
+// belong to it are looked up and torn down before the owner goes.
+void SimpleOrcJit::removeModule(ModuleHandle_t module) {
+  std::lock_guard<std::mutex> lazyLock(LazyCompileMutex);
+  std::lock_guard<std::mutex> lock(SubmitModuleMutex);
+
+  auto it = std::find_if(
+      LazyModuleSets.begin(), LazyModuleSets.end(),
+      [module](const LazyModuleSet &set) { return set.Owner == module; });
+
+  if (it != LazyModuleSets.end()) {
+    for (orc::TargetAddress callback : it->Callbacks)
+      CompileCallbacks->releaseCompileCallback(callback);
+
+    for (ModuleHandle_t compiled : it->CompiledModules)
+      OptimizeLayer.removeModuleSet(compiled);
+
+    LazyModuleSets.erase(it);
+  }
+
+  OptimizeLayer.removeModuleSet(module);
+}
+
+void SimpleOrcJit::setObjectCache(ObjectCache *cache) {
+  CompileLayer.setObjectCache(cache);
+}
+
+auto SimpleOrcJit::submitCachedModule(ModulePtr_t module, CompileStats *stats)
+    -> ModuleHandle_t {
+  std::lock_guard<std::mutex> lock(SubmitModuleMutex);
+
+  ModuleHandle_t handle = CompileLayer.addModuleSet(
+      makeModuleSet(std::move(module)), makeMemoryManager(),
+      makeLinkingResolver(OptimizeLayer));
+
+  emitAndFinalize(CompileLayer, handle, stats);
+  return handle;
+}
+
+void SimpleOrcJit::setCompileThreads(unsigned threads) {
+  CompilePool = std::make_unique<ThreadPool>(threads);
+}
+
+auto SimpleOrcJit::submitModulesParallel(std::vector<ModulePtr_t> modules,
+                                         CompileStats *stats)
+    -> ModuleHandle_t {
+  assert(CompilePool && "Call setCompileThreads() first");
+  OptimizationLevel level;
+  {
+    std::lock_guard<std::mutex> lock(SubmitModuleMutex);
+    level = OptLevel;
+  }
+
+  std::vector<std::unique_ptr<Object_t>> objects(modules.size());
+  std::atomic<size_t> nextModule(0);
+
+  // workers record into their own stats, which are summed up afterwards
+  std::vector<CompileStats> workerStats(CompilePool->getNumThreads());
+
+  CompilePool->runOnAll([&](unsigned workerIdx) {
+    // target machines are not thread-safe, so each worker needs its own
+    std::unique_ptr<TargetMachine> workerTM(TM->getTarget().createTargetMachine(
+        TM->getTargetTriple().str(), TM->getTargetCPU(),
+        TM->getTargetFeatureString(), TM->Options, TM->getRelocationModel(),
+        TM->getCodeModel(), TM->getOptLevel()));
+    orc::SimpleCompiler compile(*workerTM);
+    CompileStats *workerStat = stats ? &workerStats[workerIdx] : nullptr;
+
+    for (size_t i = nextModule++; i < modules.size(); i = nextModule++) {
+      ModulePtr_t module =
+          optimizeModule(std::move(modules[i]), level, workerStat);
+      objects[i] = std::make_unique<Object_t>(
+          compileModule(compile, *module, workerStat));
+    }
+  });
+
+  if (stats)
+    for (const CompileStats &workerStat : workerStats)
+      stats->add(workerStat);
+
+  std::lock_guard<std::mutex> lock(SubmitModuleMutex);
+
+  ModuleHandle_t handle = ObjectLayer.addObjectSet(
+      std::move(objects), makeMemoryManager(),
+      makeLinkingResolver(OptimizeLayer));
+
+  emitAndFinalize(ObjectLayer, handle, stats);
   return handle;
 }
+
+// Lazy subtree evaluators jump here if their compile callback is gone.
+static void handleLazyCompileError() {
+  report_fatal_error("Lazy compile callback failed");
+}
+
+// The lazy modules contain a single subtree evaluator each. The owner module
+// calls them through stubs, that initially point to compile callbacks.
+auto SimpleOrcJit::submitModuleLazy(
+    ModulePtr_t module, std::vector<ModulePtr_t> lazyModules,
+    std::vector<std::unique_ptr<LLVMContext>> contexts, CompileStats *stats)
+    -> ModuleHandle_t {
+  assert(lazyModules.size() == contexts.size());
+  std::lock_guard<std::mutex> lazyLock(LazyCompileMutex);
+  std::lock_guard<std::mutex> lock(SubmitModuleMutex);
+
+  if (!CompileCallbacks) {
+    const Triple &triple = TM->getTargetTriple();
+    if (triple.getArch() != Triple::x86_64 || triple.isOSWindows())
+      report_fatal_error("Lazy compilation requires x86-64 SysV");
+
+    auto errorHandler = static_cast<orc::TargetAddress>(
+        reinterpret_cast<uintptr_t>(&handleLazyCompileError));
+
+    using CallbackManager_t =
+        SerializedCompileCallbackManager<orc::OrcX86_64_SysV>;
+    CompileCallbacks =
+        std::make_unique<CallbackManager_t>(LazyCompileMutex, errorHandler);
+  }
+
+  LazyModuleSets.emplace_back();
+  LazyModuleSet &set = LazyModuleSets.back();
+  set.Stubs = orc::createLocalIndirectStubsManagerBuilder(
+      TM->getTargetTriple())();
+
+  for (size_t i = 0; i < lazyModules.size(); i++) {
+    std::string name;
+    for (const Function &function : *lazyModules[i])
+      if (!function.isDeclaration() && function.hasExternalLinkage())
+        name = function.getName();
+
+    assert(!name.empty() && "Lazy modules need an external function");
+    set.MangledNames.push_back(mangle(name));
+
+    auto callback = CompileCallbacks->getCompileCallback();
+    callback.setCompileAction([this, &set, i]() {
+      return compileLazyModule(set, i);
+    });
+
+    if (Error err = set.Stubs->createStub(set.MangledNames.back(),
+                                          callback.getAddress(),
+                                          JITSymbolFlags::Exported)) {
+      consumeError(std::move(err));
+      report_fatal_error("Failed to create stub for lazy module");
+    }
+
+    set.Callbacks.push_back(callback.getAddress());
+  }
+
+  set.CompiledAddrs.resize(lazyModules.size(), 0);
+
+  set.Modules = std::move(lazyModules);
+  set.Contexts = std::move(contexts);
+
+  SubmitStats = stats;
+  set.Owner = OptimizeLayer.addModuleSet(
+      makeModuleSet(std::move(module)), makeMemoryManager(),
+      makeLinkingResolver(OptimizeLayer, set.Stubs.get()));
+
+  SubmitStats = nullptr;
+  emitAndFinalize(OptimizeLayer, set.Owner, stats);
+  return set.Owner;
+}
+
+// Runs under LazyCompileMutex on the first call into the lazy module,
+// compiles it and patches the stub, so subsequent calls go to the compiled
+// code directly. Threads that entered the stub before it was patched run
+// this again afterwards and get the existing code.
+orc::TargetAddress SimpleOrcJit::compileLazyModule(LazyModuleSet &set,
+                                                   size_t idx) {
+  if (set.CompiledAddrs[idx] != 0)
+    return set.CompiledAddrs[idx];
+
+  std::lock_guard<std::mutex> lock(SubmitModuleMutex);
+
+  ModuleHandle_t handle = OptimizeLayer.addModuleSet(
+      makeModuleSet(std::move(set.Modules[idx])), makeMemoryManager(),
+      makeLinkingResolver(OptimizeLayer));
+
+  OptimizeLayer.emitAndFinalize(handle);
+  set.CompiledModules.push_back(handle);
+
+  // the layers don't keep the module, so its context can go
+  set.Contexts[idx].reset();
+
+  const std::string &name = set.MangledNames[idx];
+  orc::TargetAddress addr =
+      CompileLayer.findSymbolIn(handle, name, false).getAddress();
+  assert(addr != 0);
+
+  if (Error err = set.Stubs->updatePointer(name, addr)) {
+    consumeError(std::move(err));
+    report_fatal_error("Failed to patch stub for lazy module");
+  }
+
+  set.CompiledAddrs[idx] = addr;
+  return addr;
+}
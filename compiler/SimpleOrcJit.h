@@ -1,24 +1,38 @@
 #pragma once
 
 #include <functional>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
 #include <llvm/ExecutionEngine/Orc/IRCompileLayer.h>
+#include <llvm/ExecutionEngine/Orc/IndirectionUtils.h>
 #include <llvm/ExecutionEngine/Orc/IRTransformLayer.h>
 #include <llvm/ExecutionEngine/Orc/JITSymbol.h>
 #include <llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/ExecutionEngine/RuntimeDyld.h>
 #include <llvm/IR/DataLayout.h>
+#include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Object/ObjectFile.h>
 #include <llvm/Target/TargetMachine.h>
 
+#include "compiler/CompileStats.h"
+#include "compiler/OptimizationLevel.h"
+#include "compiler/PooledMemoryManager.h"
+#include "driver/utility/ThreadPool.h"
+
 using llvm::orc::IRCompileLayer;
 using llvm::orc::IRTransformLayer;
 using llvm::orc::ObjectLinkingLayer;
 
 class SimpleOrcJit {
   using ModulePtr_t = std::unique_ptr<llvm::Module>;
+  using Object_t = llvm::object::OwningBinary<llvm::object::ObjectFile>;
   using Optimize_f = std::function<ModulePtr_t(ModulePtr_t)>;
 
   using ObjectLayer_t = ObjectLinkingLayer<>;
@@ -29,7 +43,47 @@ public:
   using ModuleHandle_t = OptimizeLayer_t::ModuleSetHandleT;
 
   SimpleOrcJit(llvm::TargetMachine *targetMachine);
-  ModuleHandle_t submitModule(ModulePtr_t module);
+
+  // the submit functions add the time of optimization, machine code emission
+  // and linking as well as the code sizes to the given stats
+  ModuleHandle_t submitModule(ModulePtr_t module,
+                              CompileStats *stats = nullptr);
+
+  // applies to modules submitted afterwards
+  void setOptimizationLevel(OptimizationLevel level);
+
+  // frees the module's code and data sections
+  void removeModule(ModuleHandle_t module);
+
+  // modules submitted afterwards allocate their sections from the pool, that
+  // may be shared with other JITs, instead of mapping their own pages
+  void setCodeMemoryPool(std::shared_ptr<CodeMemoryPool> pool);
+
+  // the compile layer checks the cache for each module before compiling it
+  // and passes new objects to it
+  void setObjectCache(llvm::ObjectCache *cache);
+
+  // submit an empty module whose object the cache can provide, skipping the
+  // optimizer and the compiler
+  ModuleHandle_t submitCachedModule(ModulePtr_t module,
+                                    CompileStats *stats = nullptr);
+
+  // optimize and compile the modules on the compile threads and link the
+  // objects as one set, so they can call each other's external functions
+  void setCompileThreads(unsigned threads);
+  ModuleHandle_t submitModulesParallel(std::vector<ModulePtr_t> modules,
+                                       CompileStats *stats = nullptr);
+
+  // Compile the module right away and each of the lazy modules on the first
+  // call to its external function, which goes through a stub until then.
+  // The lazy modules must be in the given contexts, one each, which are kept
+  // alive until their module is compiled. Threads may call into uncompiled
+  // subtrees concurrently: the first one compiles the module, the others
+  // wait for it and continue in the compiled code.
+  ModuleHandle_t
+  submitModuleLazy(ModulePtr_t module, std::vector<ModulePtr_t> lazyModules,
+                   std::vector<std::unique_ptr<llvm::LLVMContext>> contexts,
+                   CompileStats *stats = nullptr);
 
   template<typename Evaluator_f>
   Evaluator_f *getFnPtr(std::string unmangledName) {
@@ -42,15 +96,46 @@ public:
   }
 
 private:
+  llvm::TargetMachine *TM;
   ObjectLayer_t ObjectLayer;
   CompileLayer_t CompileLayer;
   OptimizeLayer_t OptimizeLayer;
   llvm::DataLayout TargetDataLayout;
-  static std::mutex SubmitModuleMutex;
+  // serializes submissions and symbol lookups on the layers of this
+  // instance, nothing else
+  std::mutex SubmitModuleMutex;
+  std::unique_ptr<ThreadPool> CompilePool;
+  OptimizationLevel OptLevel = OptimizationLevel::Max;
+  CompileStats *SubmitStats = nullptr; // set while the layers compile
+  std::shared_ptr<CodeMemoryPool> CodePool;
+
+  // the lazy modules of one submitModuleLazy() call
+  struct LazyModuleSet {
+    ModuleHandle_t Owner;
+    std::unique_ptr<llvm::orc::IndirectStubsManager> Stubs;
+    std::vector<ModulePtr_t> Modules;
+    std::vector<std::unique_ptr<llvm::LLVMContext>> Contexts;
+    std::vector<std::string> MangledNames;
+    std::vector<llvm::orc::TargetAddress> Callbacks; // released on unload
+    std::vector<llvm::orc::TargetAddress> CompiledAddrs; // 0 if pending
+    std::vector<ModuleHandle_t> CompiledModules;
+  };
+
+  // serializes compile callbacks, taken before SubmitModuleMutex
+  std::mutex LazyCompileMutex;
+  std::unique_ptr<llvm::orc::JITCompileCallbackManager> CompileCallbacks;
+  std::list<LazyModuleSet> LazyModuleSets; // stable addresses for callbacks
+
+  llvm::orc::TargetAddress compileLazyModule(LazyModuleSet &set, size_t idx);
 
-  ModulePtr_t optimizeModule(ModulePtr_t module);
+  ModulePtr_t optimizeModule(ModulePtr_t module, OptimizationLevel level);
+  ModulePtr_t optimizeModule(ModulePtr_t module, OptimizationLevel level,
+                             CompileStats *stats);
+  Object_t compileModule(const llvm::orc::SimpleCompiler &compile,
+                         llvm::Module &module, CompileStats *stats);
   llvm::orc::TargetAddress getFnAddress(std::string unmangledName);
   llvm::orc::TargetAddress getFnAddressIn(ModuleHandle_t module,
                                           std::string unmangledName);
   std::string mangle(std::string name);
+  std::unique_ptr<llvm::RuntimeDyld::MemoryManager> makeMemoryManager();
 };
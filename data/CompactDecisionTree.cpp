@@ -0,0 +1,173 @@
+#include "data/CompactDecisionTree.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "data/DecisionTreeNode.h"
+
+CompactDecisionTree::CompactDecisionTree(const DecisionTree &tree,
+                                         CompactLayout layout,
+                                         uint8_t blockLevels) {
+  std::vector<Node> nodes = layout == CompactLayout::Blocked
+                                ? buildBlocked(tree, blockLevels)
+                                : buildLevelOrder(tree);
+
+  assert(nodes.size() <= std::numeric_limits<uint32_t>::max());
+  NumNodes = nodes.size();
+
+  // the vector's storage is only aligned to the node size
+  constexpr size_t nodesPerLine = CacheLineSize / sizeof(Node);
+  Nodes.resize(NumNodes + nodesPerLine - 1);
+
+  uintptr_t misalignment = (uintptr_t)Nodes.data() % CacheLineSize;
+  assert(misalignment % sizeof(Node) == 0);
+  Offset = misalignment ? (CacheLineSize - misalignment) / sizeof(Node) : 0;
+
+  std::copy(nodes.begin(), nodes.end(), Nodes.begin() + Offset);
+}
+
+CompactDecisionTree::Node
+CompactDecisionTree::makeNode(const DecisionTreeNode *node,
+                              uint32_t firstChildIdx,
+                              uint32_t rightChildOffset) {
+  // result indices of trees deeper than 32 levels need all 64 bits
+  if (node->isImplicit())
+    return {0.0f, NoFeatureIdx, (uint32_t)node->getIdx(),
+            (uint32_t)(node->getIdx() >> 32)};
+
+  assert(!node->hasSingleChild() || rightChildOffset == 0);
+  assert(node->getFeatureIdx() != NoFeatureIdx);
+  return {node->getFeatureBias(), node->getFeatureIdx(), firstChildIdx,
+          rightChildOffset};
+}
+
+// Single-child nodes continue there for both evaluations, so they only
+// allocate one child slot and have a right child offset of 0.
+void CompactDecisionTree::pushChildIdxs(const DecisionTreeNode *node,
+                                        std::vector<uint64_t> &idxs) {
+  if (node->hasLeftChild())
+    idxs.push_back(node->getLeftChildIdx());
+  if (node->hasRightChild())
+    idxs.push_back(node->getRightChildIdx());
+}
+
+uint32_t CompactDecisionTree::getRightChildOffset(const DecisionTreeNode *node,
+                                                  uint32_t offset) {
+  return node->hasSingleChild() ? 0 : offset;
+}
+
+// Breadth-first, so children get adjacent slots even if the tree's own
+// indices don't have them side by side. For perfect trees the order matches
+// the tree's level-order indices.
+std::vector<CompactDecisionTree::Node>
+CompactDecisionTree::buildLevelOrder(const DecisionTree &tree) {
+  std::vector<uint64_t> treeIdxs;
+  treeIdxs.reserve(tree.getNumNodeSlots());
+  treeIdxs.push_back(tree.getRootNodeIdx());
+
+  std::vector<Node> nodes;
+  nodes.reserve(tree.getNumNodeSlots());
+
+  for (size_t i = 0; i < treeIdxs.size(); i++) {
+    const DecisionTreeNode *node = tree.getNodePtr(treeIdxs[i]);
+    auto firstChildIdx = (uint32_t)treeIdxs.size();
+
+    if (!node->isImplicit())
+      pushChildIdxs(node, treeIdxs);
+
+    nodes.push_back(
+        makeNode(node, firstChildIdx, getRightChildOffset(node, 1)));
+  }
+
+  return nodes;
+}
+
+// Each block holds a subtree of blockLevels levels in level order plus one
+// padding slot, so blocks have a power of two size and stay aligned to cache
+// lines. The inner children of a block's bottom nodes are the roots of new
+// blocks. Result children don't need a subtree, they are packed into shared
+// blocks of result nodes instead. Children are allocated left to right, so
+// the right one always comes after the left one.
+std::vector<CompactDecisionTree::Node>
+CompactDecisionTree::buildBlocked(const DecisionTree &tree,
+                                  uint8_t blockLevels) {
+  assert(blockLevels > 0 && blockLevels < 8);
+  uint32_t blockSize = PowerOf2<uint32_t>(blockLevels);
+  uint32_t blockNodes = blockSize - 1;
+
+  std::vector<Node> nodes(blockSize);
+  std::vector<uint64_t> blockRootIdxs{tree.getRootNodeIdx()};
+  std::vector<uint32_t> blockBases{0};
+  std::vector<const DecisionTreeNode *> blockTreeNodes(blockNodes);
+
+  // next free slot in the current block of result nodes, which is full if
+  // the slot is at a block boundary, initially slot 0 at the root
+  uint32_t nextResultSlot = 0;
+
+  auto allocBlock = [&](uint64_t rootIdx) {
+    auto base = (uint32_t)nodes.size();
+    nodes.resize(nodes.size() + blockSize);
+    blockRootIdxs.push_back(rootIdx);
+    blockBases.push_back(base);
+    return base;
+  };
+
+  auto allocResult = [&](const DecisionTreeNode *node, uint32_t minIdx) {
+    if (nextResultSlot % blockSize == 0 || nextResultSlot <= minIdx) {
+      nextResultSlot = (uint32_t)nodes.size();
+      nodes.resize(nodes.size() + blockSize);
+    }
+
+    nodes[nextResultSlot] = makeNode(node, 0, 0);
+    return nextResultSlot++;
+  };
+
+  for (size_t block = 0; block < blockRootIdxs.size(); block++) {
+    uint32_t base = blockBases[block];
+
+    std::fill(blockTreeNodes.begin(), blockTreeNodes.end(), nullptr);
+    blockTreeNodes[0] = tree.getNodePtr(blockRootIdxs[block]);
+
+    for (uint32_t i = 0; i < blockNodes; i++) {
+      const DecisionTreeNode *node = blockTreeNodes[i];
+      if (!node)
+        continue;
+
+      if (node->isImplicit()) {
+        nodes[base + i] = makeNode(node, 0, 0);
+        continue;
+      }
+
+      uint32_t localChildIdx = 2 * i + 1;
+      if (localChildIdx < blockNodes) {
+        // the right slot stays empty for single-child nodes
+        const DecisionTreeNode **childSlot = &blockTreeNodes[localChildIdx];
+        if (node->hasLeftChild())
+          *childSlot++ = tree.getNodePtr(node->getLeftChildIdx());
+        if (node->hasRightChild())
+          *childSlot = tree.getNodePtr(node->getRightChildIdx());
+
+        nodes[base + i] = makeNode(node, base + localChildIdx,
+                                   getRightChildOffset(node, 1));
+      } else {
+        std::vector<uint64_t> childIdxs;
+        pushChildIdxs(node, childIdxs);
+
+        uint32_t childSlots[2] = {0, 0};
+        for (size_t c = 0; c < childIdxs.size(); c++) {
+          const DecisionTreeNode *child = tree.getNodePtr(childIdxs[c]);
+          childSlots[c] = child->isImplicit()
+                              ? allocResult(child, childSlots[0])
+                              : allocBlock(childIdxs[c]);
+        }
+
+        // 0 for single-child nodes
+        uint32_t rightChildOffset =
+            childSlots[1] ? childSlots[1] - childSlots[0] : 0;
+        nodes[base + i] = makeNode(node, childSlots[0], rightChildOffset);
+      }
+    }
+  }
+
+  return nodes;
+}
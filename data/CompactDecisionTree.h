@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "data/DecisionTree.h"
+
+// LevelOrder keeps the tree's level order. Blocked packs subtrees of a few
+// levels into cache-line aligned blocks and places the two child blocks of
+// each node next to each other, so deep walks touch one block per few levels
+// instead of a new cache line on every level.
+enum class CompactLayout { LevelOrder, Blocked };
+
+// Packed read-only copy of a finalized tree for the Interpreter. Nodes take
+// 16 bytes, so four of them share a cache line and deep trees mostly stay in
+// L1/L2 while evaluating. The left child of a node is at FirstChildIdx and
+// its right child follows RightChildOffset nodes later, which is 1 unless
+// the children are in different blocks or 0 for nodes with a single child.
+class CompactDecisionTree {
+public:
+  struct Node {
+    float Bias;
+
+    // NoFeatureIdx for result nodes
+    uint32_t FeatureIdx;
+
+    // index of the left child or, for result nodes, the lower half of the
+    // tree's result node index
+    uint32_t FirstChildIdx;
+
+    // the upper half of the result node index for result nodes
+    uint32_t RightChildOffset;
+
+    bool isResult() const { return FeatureIdx == NoFeatureIdx; }
+
+    uint64_t getResultIdx() const {
+      assert(isResult());
+      return (uint64_t)RightChildOffset << 32 | FirstChildIdx;
+    }
+  };
+
+  static_assert(sizeof(Node) == 16, "Four nodes per cache line");
+
+  static constexpr uint32_t NoFeatureIdx = 0xFFFFFFFF;
+  static constexpr unsigned CacheLineSize = 64;
+
+  CompactDecisionTree() = default;
+  CompactDecisionTree(CompactDecisionTree &&) = default;
+  CompactDecisionTree &operator=(CompactDecisionTree &&) = default;
+
+  // blocks of 2 levels fill one cache line, blocks of 3 levels two adjacent
+  // ones
+  explicit CompactDecisionTree(const DecisionTree &tree,
+                               CompactLayout layout = CompactLayout::LevelOrder,
+                               uint8_t blockLevels = 3);
+
+  const Node *getNodes() const {
+    assert(!Nodes.empty());
+    return Nodes.data() + Offset;
+  }
+
+  // includes the padding slots of the blocked layout
+  uint64_t getNumNodes() const { return NumNodes; }
+
+private:
+  // over-allocated by up to one cache line to align the first node
+  std::vector<Node> Nodes;
+  uint64_t Offset = 0;
+  uint64_t NumNodes = 0;
+
+  static std::vector<Node> buildLevelOrder(const DecisionTree &tree);
+  static std::vector<Node> buildBlocked(const DecisionTree &tree,
+                                        uint8_t blockLevels);
+
+  static Node makeNode(const DecisionTreeNode *node, uint32_t firstChildIdx,
+                       uint32_t rightChildOffset);
+
+  static void pushChildIdxs(const DecisionTreeNode *node,
+                            std::vector<uint64_t> &idxs);
+  static uint32_t getRightChildOffset(const DecisionTreeNode *node,
+                                      uint32_t offset);
+};
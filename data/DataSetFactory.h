@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "data/DecisionTree.h"
@@ -10,13 +11,18 @@
 class DataSetFactory {
 public:
   DataSetFactory() = default;
+  // random data-sets don't need a finalized tree
   DataSetFactory(DecisionTree tree, uint32_t features)
+      : Tree(std::make_shared<const DecisionTree>(std::move(tree))),
+        Features(features) {}
+
+  DataSetFactory(DecisionTreeHandle tree, uint32_t features)
       : Tree(std::move(tree)), Features(features) {}
 
   template <typename ...Args_tt>
   std::vector<float> makeDistinctDataSet(NodeEvaluation l1, Args_tt... args) {
     std::vector<float> ds(Features, 0.0f);
-    fillDataSetRecursively(ds, Tree.getRootNode(), l1, args...);
+    fillDataSetRecursively(ds, Tree->getRootNode(), l1, args...);
     return ds;
   }
 
@@ -36,8 +42,15 @@ public:
     return dataSetCollection;
   }
 
+  // rows data-sets in one contiguous block with a row stride of Features
+  std::vector<float> makeRandomDataSetBlock(uint32_t rows) {
+    std::vector<float> block((size_t)rows * Features);
+    std::generate(block.begin(), block.end(), makeRandomFloat);
+    return block;
+  }
+
 private:
-  DecisionTree Tree;
+  DecisionTreeHandle Tree;
   uint32_t Features;
 
   template <typename ...Args_tt>
@@ -46,7 +59,7 @@ private:
     ds[node.getFeatureIdx()] = getAdjustedBias(node, eval);
 
     assert(node.hasChildFor(eval));
-    fillDataSetRecursively(ds, Tree.getChildNodeFor(node, eval), childEvals...);
+    fillDataSetRecursively(ds, Tree->getChildNodeFor(node, eval), childEvals...);
   }
 
   template <typename ...Args_tt>
@@ -0,0 +1,111 @@
+#include "data/DataSetFile.h"
+
+#include <cstring>
+#include <vector>
+
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace llvm;
+
+constexpr char DataSetFileHeader::ExpectedMagic[8];
+constexpr uint32_t DataSetFileHeader::CurrentVersion;
+constexpr uint32_t DataSetFileHeader::RowAlignment;
+
+std::error_code writeDataSetFile(std::string fileName, const float *rows,
+                                 uint64_t numRows, uint32_t features,
+                                 uint64_t inputStride) {
+  assert(features > 0 && inputStride >= features);
+  constexpr uint64_t floatsPerAlignment =
+      DataSetFileHeader::RowAlignment / sizeof(float);
+
+  DataSetFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.Magic, DataSetFileHeader::ExpectedMagic, 8);
+  header.Version = DataSetFileHeader::CurrentVersion;
+  header.Features = features;
+  header.Rows = numRows;
+  header.RowStride = alignTo(features, floatsPerAlignment);
+  header.DataOffset = sizeof(DataSetFileHeader);
+
+  std::error_code EC;
+  raw_fd_ostream out(fileName, EC, sys::fs::F_None);
+  if (EC)
+    return EC;
+
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  std::vector<float> paddedRow(header.RowStride, 0.0f);
+  for (uint64_t i = 0; i < numRows; i++) {
+    std::copy(rows, rows + features, paddedRow.begin());
+    out.write(reinterpret_cast<const char *>(paddedRow.data()),
+              paddedRow.size() * sizeof(float));
+    rows += inputStride;
+  }
+
+  out.close();
+  if (out.has_error()) {
+    out.clear_error();
+    return std::make_error_code(std::errc::io_error);
+  }
+
+  return std::error_code();
+}
+
+ErrorOr<std::unique_ptr<MappedDataSet>>
+MappedDataSet::open(std::string fileName) {
+  int FD;
+  if (std::error_code EC = sys::fs::openFileForRead(fileName, FD))
+    return EC;
+
+  sys::fs::file_status status;
+  if (std::error_code EC = sys::fs::status(FD, status)) {
+    sys::Process::SafelyCloseFileDescriptor(FD);
+    return EC;
+  }
+
+  uint64_t fileSize = status.getSize();
+  auto invalidFile = std::make_error_code(std::errc::invalid_argument);
+
+  if (fileSize < sizeof(DataSetFileHeader)) {
+    sys::Process::SafelyCloseFileDescriptor(FD);
+    return invalidFile;
+  }
+
+  // the mapping stays valid after closing the file
+  std::error_code EC;
+  auto region = std::make_unique<sys::fs::mapped_file_region>(
+      FD, sys::fs::mapped_file_region::priv, fileSize, 0, EC);
+
+  sys::Process::SafelyCloseFileDescriptor(FD);
+  if (EC)
+    return EC;
+
+  auto *header = reinterpret_cast<const DataSetFileHeader *>(region->const_data());
+  uint64_t floatsPerAlignment = DataSetFileHeader::RowAlignment / sizeof(float);
+
+  // header values are untrusted, check the data size without overflows
+  bool valid =
+      std::memcmp(header->Magic, DataSetFileHeader::ExpectedMagic, 8) == 0 &&
+      header->Version == DataSetFileHeader::CurrentVersion &&
+      header->Features > 0 &&
+      header->RowStride >= header->Features &&
+      header->RowStride % floatsPerAlignment == 0 &&
+      header->DataOffset % DataSetFileHeader::RowAlignment == 0 &&
+      header->DataOffset <= fileSize &&
+      header->Rows <=
+          (fileSize - header->DataOffset) / sizeof(float) / header->RowStride;
+
+  if (!valid)
+    return invalidFile;
+
+  return std::unique_ptr<MappedDataSet>(new MappedDataSet(std::move(region)));
+}
+
+MappedDataSet::MappedDataSet(
+    std::unique_ptr<sys::fs::mapped_file_region> region)
+    : Region(std::move(region)) {
+  Header = reinterpret_cast<const DataSetFileHeader *>(Region->const_data());
+  Data = reinterpret_cast<float *>(Region->data() + Header->DataOffset);
+}
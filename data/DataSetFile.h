@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/FileSystem.h>
+
+// Binary data-set file format:
+// * 64 byte header
+// * row-major matrix of 32 bit floats in host byte order starting at
+//   DataOffset, every row padded with zeros to RowStride floats, so that all
+//   rows are 32 byte aligned
+struct DataSetFileHeader {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t Features;
+  uint64_t Rows;
+  uint64_t RowStride;  // in floats, multiple of 8
+  uint64_t DataOffset; // in bytes, multiple of 32
+  uint8_t Reserved[24];
+
+  static constexpr char ExpectedMagic[8] = "ETJDSET";
+  static constexpr uint32_t CurrentVersion = 1;
+  static constexpr uint32_t RowAlignment = 32;
+};
+
+static_assert(sizeof(DataSetFileHeader) == 64, "Header size is fixed");
+
+// Write numRows rows of the given number of features. Input rows are
+// inputStride floats apart.
+std::error_code writeDataSetFile(std::string fileName, const float *rows,
+                                 uint64_t numRows, uint32_t features,
+                                 uint64_t inputStride);
+
+// Data-set file mapped into memory. Rows are handed out
+// as pointers into the mapping, without parsing or copying. The mapping is
+// private, so pages are only copied if someone writes to them.
+class MappedDataSet {
+public:
+  static llvm::ErrorOr<std::unique_ptr<MappedDataSet>>
+  open(std::string fileName);
+
+  uint32_t getNumFeatures() const { return Header->Features; }
+  uint64_t getNumRows() const { return Header->Rows; }
+  uint64_t getRowStride() const { return Header->RowStride; }
+
+  // non-const for Evaluator_f
+  float *getRow(uint64_t idx) const {
+    assert(idx < Header->Rows);
+    return Data + idx * Header->RowStride;
+  }
+
+  float *getData() const { return Data; }
+
+private:
+  std::unique_ptr<llvm::sys::fs::mapped_file_region> Region;
+  const DataSetFileHeader *Header;
+  float *Data;
+
+  MappedDataSet(std::unique_ptr<llvm::sys::fs::mapped_file_region> region);
+};
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <list>
+#include <llvm/ADT/SmallVector.h>
 
 #include "data/DecisionTree.h"
 #include "data/DecisionTreeNode.h"
@@ -17,28 +17,36 @@ struct DecisionSubtreeRef {
   DecisionSubtreeRef(const DecisionTree *tree, DecisionTreeNode root,
                      uint8_t levels);
 
+  // complete subtrees have regular nodes on all of their levels, so none of
+  // their paths ends early or skips a decision
   bool isComplete() const {
-    // todo: implement this for non-regular trees
-    return true;
+    return NodeCount == TreeNodes(Levels) &&
+           ContinuationNodeCount == NodeCount + 1;
   }
 
   DecisionTreeNode getNode(uint64_t idx) const {
     return Tree->getNode(idx);
   }
 
-  uint8_t getNodeCount() const { return (uint8_t)(PowerOf2(Levels) - 1); }
-  uint8_t getContinuationNodeCount() const { return PowerOf2<uint8_t>(Levels); }
+  // regular nodes only, result nodes within the subtree's levels are
+  // continuation nodes like the ones below it
+  uint8_t getNodeCount() const { return NodeCount; }
+  uint8_t getContinuationNodeCount() const { return ContinuationNodeCount; }
 
-  std::list<DecisionTreeNode> collectNodesPreOrder() const;
+  // subtrees have at most 4 levels, so their nodes always fit inline
+  using NodeVector = llvm::SmallVector<DecisionTreeNode, 15>;
+  NodeVector collectNodesPreOrder() const;
 
   DecisionTreeNode Root;
   uint8_t Levels;
 
 private:
   const DecisionTree *Tree;
+  uint8_t NodeCount;
+  uint8_t ContinuationNodeCount;
 
-  std::list<DecisionTreeNode> collectNodesRecursively(
-      DecisionTreeNode n, int levels) const;
+  void collectNodesRecursively(const DecisionTreeNode &n, int levels,
+                               NodeVector &nodes) const;
 };
 
 inline DecisionSubtreeRef::DecisionSubtreeRef(const DecisionTree *tree,
@@ -49,36 +57,45 @@ inline DecisionSubtreeRef::DecisionSubtreeRef(const DecisionTree *tree,
   assert(Levels > 0 && Levels <= 4); // max node count is 31
   assert(Tree->getNode(Root.getIdx()) == Root);
 
-  // make sure we have a complete subtree
-  assert(collectNodesPreOrder().size() == TreeNodes(Levels));
+  // every decision adds one continuation, single-child nodes don't decide
+  NodeVector nodes = collectNodesPreOrder();
+  NodeCount = nodes.size();
+  ContinuationNodeCount = 1;
+  for (const DecisionTreeNode &node : nodes)
+    if (!node.hasSingleChild())
+      ContinuationNodeCount++;
 }
 
-inline std::list<DecisionTreeNode>
+inline DecisionSubtreeRef::NodeVector
 DecisionSubtreeRef::collectNodesPreOrder() const {
-  std::list<DecisionTreeNode> nodes = collectNodesRecursively(Root, Levels - 1);
-  nodes.push_front(std::move(Root));
+  NodeVector nodes;
+  nodes.push_back(Root);
+  collectNodesRecursively(Root, Levels - 1, nodes);
 
   return nodes;
 }
 
-inline std::list<DecisionTreeNode>
-DecisionSubtreeRef::collectNodesRecursively(DecisionTreeNode n,
-                                            int levels) const {
+inline void
+DecisionSubtreeRef::collectNodesRecursively(const DecisionTreeNode &n,
+                                            int levels,
+                                            NodeVector &nodes) const {
   if (levels > 0) {
-    std::list<DecisionTreeNode> ns;
-
     if (n.hasLeftChild()) {
-      ns.push_back(n.getChildFor(NodeEvaluation::ContinueZeroLeft, *this));
-      ns.splice(ns.end(), collectNodesRecursively(ns.back(), levels - 1));
+      DecisionTreeNode child =
+          n.getChildFor(NodeEvaluation::ContinueZeroLeft, *this);
+      if (!child.isImplicit()) {
+        nodes.push_back(child);
+        collectNodesRecursively(child, levels - 1, nodes);
+      }
     }
 
     if (n.hasRightChild()) {
-      ns.push_back(n.getChildFor(NodeEvaluation::ContinueOneRight, *this));
-      ns.splice(ns.end(), collectNodesRecursively(ns.back(), levels - 1));
+      DecisionTreeNode child =
+          n.getChildFor(NodeEvaluation::ContinueOneRight, *this);
+      if (!child.isImplicit()) {
+        nodes.push_back(child);
+        collectNodesRecursively(child, levels - 1, nodes);
+      }
     }
-
-    return ns;
   }
-
-  return {};
 }
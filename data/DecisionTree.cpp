@@ -1,6 +1,10 @@
 #include "data/DecisionTree.h"
 
+#include <algorithm>
+
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
 #include <llvm/Support/Path.h>
 
 #include "data/DecisionSubtreeRef.h"
@@ -8,7 +12,7 @@
 
 DecisionTree::DecisionTree(uint8_t levels, uint64_t nodes) {
   Levels = levels;
-  Nodes.reserve(nodes);
+  PendingNodes.reserve(nodes);
   Finalized = false;
 }
 
@@ -16,33 +20,136 @@ DecisionTree DecisionTree::copy() const {
   return *this;
 }
 
+void DecisionTree::addToHash(llvm::MD5 &hasher) const {
+  assert(Finalized);
+  auto update = [&hasher](const auto &value) {
+    hasher.update(llvm::ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(&value), sizeof(value)));
+  };
+
+  update(Levels);
+  update(NodeIdxBound);
+  update(PayloadKind);
+
+  for (const DecisionTreeNode &node : Nodes) {
+    uint64_t idx = node.NodeIdx;
+    if (idx == DecisionTreeNode::NoNodeIdx)
+      continue;
+
+    update(idx);
+    update(node.DataSetFeatureIdx);
+    update(node.Bias);
+    update(node.FalseChildNodeIdx);
+    update(node.TrueChildNodeIdx);
+
+    auto payloadIt = LeafPayloads.find(idx);
+    if (payloadIt == LeafPayloads.end())
+      continue;
+
+    if (PayloadKind == LeafPayloadKind::Score)
+      update(payloadIt->second.Score);
+    else
+      update(payloadIt->second.ClassId);
+  }
+}
+
 void DecisionTree::finalize() {
-  assert(Nodes.size() == TreeNodes(Levels));
+  assert(PendingNodes.size() <= TreeNodes(Levels));
+  assert(PendingNodes.find(getRootNodeIdx()) != PendingNodes.end());
   assert(!Finalized);
 
-  auto idxLess = [](const auto &lhsPair, const auto &rhsPair) {
-    assert(lhsPair.first == lhsPair.second.getIdx());
-    assert(rhsPair.first == rhsPair.second.getIdx());
-    return lhsPair.first < rhsPair.first;
-  };
+  NodeIdxBound = 0;
+  for (const auto &pairIdxNode : PendingNodes) {
+    const DecisionTreeNode &node = pairIdxNode.second;
+    assert(pairIdxNode.first == node.getIdx());
+    assert(!node.isLeaf() && "Results are implicit, all nodes need children");
 
-  auto addResultNodeIfNecessary = [this](uint64_t idx) {
-    if (idx != DecisionTreeNode::NoNodeIdx && idx >= FirstResultIdx) {
-      addImplicitNode(idx);
-    }
-  };
+    NodeIdxBound = std::max(NodeIdxBound, pairIdxNode.first + 1);
+    for (uint64_t childIdx : {node.FalseChildNodeIdx, node.TrueChildNodeIdx})
+      if (childIdx != DecisionTreeNode::NoNodeIdx)
+        NodeIdxBound = std::max(NodeIdxBound, childIdx + 1);
+  }
 
-  auto maxIdxIt = std::max_element(Nodes.begin(), Nodes.end(), idxLess);
-  FirstResultIdx = maxIdxIt->second.getIdx() + 1;
+  // children without a regular node are implicit result nodes, in unbalanced
+  // trees they can be on any level
+  std::vector<uint64_t> resultIdxs;
+  for (const auto &pairIdxNode : PendingNodes) {
+    const DecisionTreeNode &node = pairIdxNode.second;
+    for (uint64_t childIdx : {node.FalseChildNodeIdx, node.TrueChildNodeIdx})
+      if (childIdx != DecisionTreeNode::NoNodeIdx &&
+          PendingNodes.find(childIdx) == PendingNodes.end())
+        resultIdxs.push_back(childIdx);
+  }
+
+  uint64_t numNodes = PendingNodes.size() + resultIdxs.size();
+  if (NodeIdxBound > MaxNodeIdxsPerNode * numNodes) {
+    SparseNodeIdxs.reserve(numNodes);
+    for (const auto &pairIdxNode : PendingNodes)
+      SparseNodeIdxs.push_back(pairIdxNode.first);
 
-  for (const auto &pairIdxNode : Nodes) {
-    addResultNodeIfNecessary(pairIdxNode.second.FalseChildNodeIdx);
-    addResultNodeIfNecessary(pairIdxNode.second.TrueChildNodeIdx);
+    SparseNodeIdxs.insert(SparseNodeIdxs.end(), resultIdxs.begin(),
+                          resultIdxs.end());
+    std::sort(SparseNodeIdxs.begin(), SparseNodeIdxs.end());
   }
 
+  Nodes.resize(SparseNodeIdxs.empty() ? NodeIdxBound : numNodes);
+  for (auto &pairIdxNode : PendingNodes)
+    Nodes[findNodeSlot(pairIdxNode.first)] = std::move(pairIdxNode.second);
+
+  for (uint64_t resultIdx : resultIdxs)
+    addImplicitNode(resultIdx);
+
+  // release the map's memory
+  std::unordered_map<uint64_t, DecisionTreeNode>().swap(PendingNodes);
+
   Finalized = true;
 }
 
+void DecisionTree::setLeafScore(uint64_t resultIdx, float score) {
+  LeafPayload payload;
+  payload.Score = score;
+  setLeafPayload(resultIdx, LeafPayloadKind::Score, payload);
+}
+
+void DecisionTree::setLeafClassId(uint64_t resultIdx, uint64_t classId) {
+  LeafPayload payload;
+  payload.ClassId = classId;
+  setLeafPayload(resultIdx, LeafPayloadKind::ClassId, payload);
+}
+
+uint64_t DecisionTree::findResultWithoutPayload() const {
+  assert(Finalized);
+  if (PayloadKind == LeafPayloadKind::NodeIdx)
+    return DecisionTreeNode::NoNodeIdx;
+
+  for (const DecisionTreeNode &node : Nodes)
+    if (node.NodeIdx != DecisionTreeNode::NoNodeIdx && node.isImplicit() &&
+        LeafPayloads.find(node.NodeIdx) == LeafPayloads.end())
+      return node.NodeIdx;
+
+  return DecisionTreeNode::NoNodeIdx;
+}
+
+uint64_t DecisionTree::getNumClasses() const {
+  assert(PayloadKind == LeafPayloadKind::ClassId);
+
+  uint64_t numClasses = 0;
+  for (const auto &pairIdxPayload : LeafPayloads)
+    numClasses = std::max(numClasses, pairIdxPayload.second.ClassId + 1);
+
+  return numClasses;
+}
+
+void DecisionTree::setLeafPayload(uint64_t resultIdx, LeafPayloadKind kind,
+                                  LeafPayload payload) {
+  assert(Finalized);
+  assert(getNode(resultIdx).isImplicit());
+  assert(PayloadKind == LeafPayloadKind::NodeIdx || PayloadKind == kind);
+
+  PayloadKind = kind;
+  LeafPayloads[resultIdx] = payload;
+}
+
 DecisionSubtreeRef DecisionTree::getSubtreeRef(uint64_t rootIndex,
                                                uint8_t levels) const {
   assert(Finalized);
@@ -68,8 +175,6 @@ std::string DecisionTreeFactory::initCacheDir(std::string cacheDirName) {
   std::error_code EC = llvm::sys::fs::create_directories(cacheDirName);
   assert(!EC);
 
-  // todo: save and check version file in cache directory
-
   return cacheDirName;
 }
 
@@ -312,3 +417,66 @@ DecisionTreeFactory::makePerfectRandomTree(uint8_t levels,
   tree.finalize();
   return tree;
 }
+
+/// Create a decision tree with the given number of levels and the following
+/// special properties:
+/// * Unbalanced: result nodes are on all levels, only the leftmost path is
+///   guaranteed to reach the full depth
+/// * Single children: some nodes have only one child, which is taken for both
+///   evaluations
+/// * Random: nodes have random bias and read random feature values
+///
+/// Node indices are level-order positions like in perfect trees, so absent
+/// subtrees leave gaps in the index range.
+///
+/// Example: makeUnbalancedRandomTree(4)
+///
+/// Indices (r = result node):
+///                 0
+///         1               2
+///     3       4         r   r
+///   7   r   r   10
+///  r r         r
+///
+DecisionTree
+DecisionTreeFactory::makeUnbalancedRandomTree(uint8_t levels,
+                                              uint32_t dataSetFeatures) {
+  DecisionTree tree(levels, TreeNodes(levels));
+  std::vector<uint64_t> pendingIdxs{tree.getRootNodeIdx()};
+
+  while (!pendingIdxs.empty()) {
+    uint64_t idx = pendingIdxs.back();
+    pendingIdxs.pop_back();
+
+    float bias = makeRandomFloat();
+    auto featureIdx = makeRandomInt<uint32_t>(0, dataSetFeatures - 1);
+
+    // leftmost nodes have indices 2^level - 1
+    bool leftmost = isPowerOf2(idx + 1);
+    uint64_t leftIdx = 2 * idx + 1;
+    uint64_t rightIdx = 2 * idx + 2;
+
+    if (makeRandomFloat() < 0.125f) {
+      if (leftmost || makeRandomFloat() < 0.5f)
+        rightIdx = DecisionTreeNode::NoNodeIdx;
+      else
+        leftIdx = DecisionTreeNode::NoNodeIdx;
+    }
+
+    tree.addNode(DecisionTreeNode(idx, bias, featureIdx, leftIdx, rightIdx));
+
+    if (DecisionTree::getLevelForNodeIdx(idx) + 1 == levels)
+      continue;
+
+    // children that don't become regular nodes are results
+    if (leftIdx != DecisionTreeNode::NoNodeIdx &&
+        (leftmost || makeRandomFloat() < 0.7f))
+      pendingIdxs.push_back(leftIdx);
+
+    if (rightIdx != DecisionTreeNode::NoNodeIdx && makeRandomFloat() < 0.7f)
+      pendingIdxs.push_back(rightIdx);
+  }
+
+  tree.finalize();
+  return tree;
+}
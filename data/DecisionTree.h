@@ -1,10 +1,22 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "data/DecisionTreeNode.h"
 #include "Utils.h"
 
+namespace llvm {
+class MD5;
+}
+
+// Values returned by evaluators for the tree's result nodes. Trees without
+// payloads return the index of the result node.
+enum class LeafPayloadKind { NodeIdx, Score, ClassId };
+
 class DecisionTree {
 public:
   DecisionTree() = default;
@@ -16,19 +28,97 @@ public:
 
   DecisionTree copy() const;
 
+  bool isFinalized() const { return Finalized; }
+
+  // feeds the tree's nodes and leaf payloads into the hasher in index order,
+  // so equal trees produce equal hashes independent of insertion order
+  void addToHash(llvm::MD5 &hasher) const;
+
   uint8_t getNumLevels() const { return Levels; }
   uint64_t getRootNodeIdx() const { return 0; }
 
   DecisionSubtreeRef getSubtreeRef(uint64_t rootIndex, uint8_t levels) const;
 
+  // node indices are in range [0, getNodeIdxBound())
+  uint64_t getNodeIdxBound() const {
+    assert(Finalized);
+    return NodeIdxBound;
+  }
+
+  // After finalize() nodes are stored in slots in index order. If the
+  // indices are dense enough, the index is the slot and slots of absent
+  // indices are unused. Otherwise the slots hold the tree's nodes only.
+  bool usesNodeIdxAsSlot() const {
+    assert(Finalized);
+    return SparseNodeIdxs.empty();
+  }
+
+  uint64_t getNumNodeSlots() const {
+    assert(Finalized);
+    return Nodes.size();
+  }
+
+  bool isNodeSlotUsed(uint64_t slot) const {
+    return Nodes[slot].NodeIdx != DecisionTreeNode::NoNodeIdx;
+  }
+
+  const DecisionTreeNode &getNodeInSlot(uint64_t slot) const {
+    assert(isNodeSlotUsed(slot));
+    return Nodes[slot];
+  }
+
+  uint64_t getNodeSlot(uint64_t idx) const {
+    assert(hasNode(idx));
+    return findNodeSlot(idx);
+  }
+
+  // node lookups are plain array accesses for dense indices and binary
+  // searches otherwise
+  bool hasNode(uint64_t idx) const {
+    assert(Finalized);
+    if (SparseNodeIdxs.empty())
+      return idx < Nodes.size() &&
+             Nodes[idx].NodeIdx != DecisionTreeNode::NoNodeIdx;
+
+    return std::binary_search(SparseNodeIdxs.begin(), SparseNodeIdxs.end(),
+                              idx);
+  }
+
   DecisionTreeNode getNode(uint64_t idx) const {
-    assert(Nodes.find(idx) != Nodes.end());
-    return Nodes.at(idx);
+    assert(hasNode(idx));
+    return Nodes[findNodeSlot(idx)];
   }
 
   const DecisionTreeNode *getNodePtr(uint64_t idx) const {
-    assert(Nodes.find(idx) != Nodes.end());
-    return &Nodes.at(idx);
+    assert(hasNode(idx));
+    return Nodes.data() + findNodeSlot(idx);
+  }
+
+  // payloads are attached to the implicit result nodes after finalize()
+  // and all result nodes of a tree must have the same kind of payload
+  void setLeafScore(uint64_t resultIdx, float score);
+  void setLeafClassId(uint64_t resultIdx, uint64_t classId);
+
+  LeafPayloadKind getLeafPayloadKind() const { return PayloadKind; }
+
+  // once the first payload is set, every result node needs one; returns the
+  // first result node without payload or NoNodeIdx if the payloads are
+  // complete
+  uint64_t findResultWithoutPayload() const;
+
+  // class ids are in range [0, getNumClasses())
+  uint64_t getNumClasses() const;
+
+  float getLeafScore(uint64_t resultIdx) const {
+    assert(PayloadKind == LeafPayloadKind::Score);
+    assert(LeafPayloads.find(resultIdx) != LeafPayloads.end());
+    return LeafPayloads.at(resultIdx).Score;
+  }
+
+  uint64_t getLeafClassId(uint64_t resultIdx) const {
+    assert(PayloadKind == LeafPayloadKind::ClassId);
+    assert(LeafPayloads.find(resultIdx) != LeafPayloads.end());
+    return LeafPayloads.at(resultIdx).ClassId;
   }
 
   DecisionTreeNode getRootNode() const {
@@ -51,9 +141,9 @@ public:
 
   void addNode(DecisionTreeNode node) {
     assert(!Finalized);
-    assert(Nodes.find(node.getIdx()) == Nodes.end());
+    assert(PendingNodes.find(node.getIdx()) == PendingNodes.end());
     uint64_t idx = node.getIdx(); // avoid move before read!
-    Nodes.emplace(idx, std::move(node));
+    PendingNodes.emplace(idx, std::move(node));
   }
 
   template <typename ...Args_tt>
@@ -78,21 +168,61 @@ public:
 private:
   bool Finalized = false;
   uint8_t Levels = 0;
-  uint64_t FirstResultIdx = DecisionTreeNode::NoNodeIdx;
-  std::unordered_map<uint64_t, DecisionTreeNode> Nodes;
+  uint64_t NodeIdxBound = 0;
+
+  // Nodes by slot after finalize(), unused slots hold default nodes. Nodes
+  // are added to PendingNodes until then.
+  std::vector<DecisionTreeNode> Nodes;
+  std::unordered_map<uint64_t, DecisionTreeNode> PendingNodes;
+
+  // the sorted node indices by slot, empty if the index is the slot
+  std::vector<uint64_t> SparseNodeIdxs;
+
+  // index ranges up to this many times the number of nodes are stored
+  // dense, so deep unbalanced trees don't take O(2^depth) memory
+  static constexpr uint64_t MaxNodeIdxsPerNode = 4;
+
+  union LeafPayload {
+    float Score;
+    uint64_t ClassId;
+  };
+
+  LeafPayloadKind PayloadKind = LeafPayloadKind::NodeIdx;
+  std::unordered_map<uint64_t, LeafPayload> LeafPayloads;
+
+  void setLeafPayload(uint64_t resultIdx, LeafPayloadKind kind,
+                      LeafPayload payload);
 
   // no implicit copies as they'd be too expensive, use copy() instead
   DecisionTree(const DecisionTree &) = default;
   DecisionTree &operator=(const DecisionTree &) = default;
 
+  uint64_t findNodeSlot(uint64_t idx) const {
+    if (SparseNodeIdxs.empty())
+      return idx;
+
+    return std::lower_bound(SparseNodeIdxs.begin(), SparseNodeIdxs.end(),
+                            idx) -
+           SparseNodeIdxs.begin();
+  }
+
   void addImplicitNode(uint64_t nodeIdx) {
-    DecisionTreeNode node;
+    DecisionTreeNode &node = Nodes[findNodeSlot(nodeIdx)];
     node.NodeIdx = nodeIdx;
     assert(node.isImplicit());
-    Nodes.emplace(nodeIdx, std::move(node));
   }
 };
 
+// Finalized trees are not modified anymore, so the compiler, interpreters and
+// compile results can share one instance across threads instead of copying
+// it. Leaf payloads must be set before the tree is shared.
+using DecisionTreeHandle = std::shared_ptr<const DecisionTree>;
+
+inline DecisionTreeHandle makeTreeHandle(DecisionTree tree) {
+  assert(tree.isFinalized());
+  return std::make_shared<const DecisionTree>(std::move(tree));
+}
+
 class DecisionTreeFactory {
 public:
   DecisionTreeFactory(std::string cacheDirName = std::string{});
@@ -104,6 +234,10 @@ public:
   DecisionTree makePerfectDistinctUniformTree(uint8_t levels);
 
   DecisionTree makePerfectRandomTree(uint8_t levels, uint32_t dataSetFeatures);
+  DecisionTree makeUnbalancedRandomTree(uint8_t levels,
+                                        uint32_t dataSetFeatures);
+
+  const std::string &getCacheDir() const { return CacheDir; }
 
 private:
   std::string CacheDir;
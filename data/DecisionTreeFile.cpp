@@ -0,0 +1,140 @@
+#include "data/DecisionTreeFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <system_error>
+#include <unordered_map>
+
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <json.hpp>
+
+#include "data/DecisionTreeNode.h"
+
+using namespace llvm;
+using json = nlohmann::json;
+
+// nodes deeper than this would overflow the level-order indices of their
+// result nodes
+static constexpr uint8_t MaxNodeLevel = 61;
+
+static bool readNodeIdx(const json &node, const char *key, uint64_t &idx) {
+  auto it = node.find(key);
+  if (it == node.end()) {
+    idx = DecisionTreeNode::NoNodeIdx;
+    return true;
+  }
+
+  if (!it->is_number_unsigned())
+    return false;
+
+  idx = it->get<uint64_t>();
+  return true;
+}
+
+static bool readNode(const json &node, DecisionTreeNode &result) {
+  if (!node.is_object())
+    return false;
+
+  auto id = node.find("id");
+  auto feature = node.find("feature");
+  auto bias = node.find("bias");
+
+  if (id == node.end() || !id->is_number_unsigned() ||
+      feature == node.end() || !feature->is_number_unsigned() ||
+      bias == node.end() || !bias->is_number())
+    return false;
+
+  uint64_t idx = id->get<uint64_t>();
+  uint64_t featureIdx = feature->get<uint64_t>();
+  float biasValue = bias->get<float>();
+
+  if (idx == DecisionTreeNode::NoNodeIdx ||
+      DecisionTree::getLevelForNodeIdx(idx) > MaxNodeLevel ||
+      featureIdx >= UINT32_MAX || std::isnan(biasValue))
+    return false;
+
+  uint64_t leftIdx, rightIdx;
+  if (!readNodeIdx(node, "left", leftIdx) ||
+      !readNodeIdx(node, "right", rightIdx))
+    return false;
+
+  // children at their level-order positions, at least one of them
+  bool leftOk =
+      (leftIdx == DecisionTreeNode::NoNodeIdx || leftIdx == 2 * idx + 1);
+  bool rightOk =
+      (rightIdx == DecisionTreeNode::NoNodeIdx || rightIdx == 2 * idx + 2);
+
+  if (!leftOk || !rightOk || leftIdx == rightIdx)
+    return false;
+
+  result = DecisionTreeNode(idx, biasValue, featureIdx, leftIdx, rightIdx);
+  return true;
+}
+
+ErrorOr<DecisionTree> readDecisionTreeFile(std::string fileName) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> buffer =
+      MemoryBuffer::getFile(fileName);
+
+  if (!buffer)
+    return buffer.getError();
+
+  auto invalidFile = std::make_error_code(std::errc::invalid_argument);
+
+  json file;
+  try {
+    file = json::parse((*buffer)->getBuffer().str());
+  } catch (const std::exception &) {
+    return invalidFile;
+  }
+
+  if (!file.is_object())
+    return invalidFile;
+
+  auto nodesIt = file.find("nodes");
+  if (nodesIt == file.end() || !nodesIt->is_array() || nodesIt->empty())
+    return invalidFile;
+
+  std::unordered_map<uint64_t, DecisionTreeNode> nodes;
+  nodes.reserve(nodesIt->size());
+
+  uint8_t levels = 0;
+  for (const json &entry : *nodesIt) {
+    DecisionTreeNode node;
+    if (!readNode(entry, node))
+      return invalidFile;
+
+    if (!nodes.emplace(node.getIdx(), node).second)
+      return invalidFile;
+
+    uint8_t level = DecisionTree::getLevelForNodeIdx(node.getIdx());
+    levels = std::max<uint8_t>(levels, level + 1);
+  }
+
+  // all nodes must be reachable from the root
+  for (const auto &pairIdxNode : nodes) {
+    uint64_t idx = pairIdxNode.first;
+    if (idx == 0)
+      continue;
+
+    auto parentIt = nodes.find((idx - 1) / 2);
+    if (parentIt == nodes.end())
+      return invalidFile;
+
+    const DecisionTreeNode &parent = parentIt->second;
+    if (parent.getLeftChildIdx() != idx && parent.getRightChildIdx() != idx)
+      return invalidFile;
+  }
+
+  if (nodes.find(0) == nodes.end())
+    return invalidFile;
+
+  DecisionTree tree(levels, nodes.size());
+  for (auto &pairIdxNode : nodes)
+    tree.addNode(std::move(pairIdxNode.second));
+
+  tree.finalize();
+  return std::move(tree);
+}
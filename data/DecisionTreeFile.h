@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+#include <llvm/Support/ErrorOr.h>
+
+#include "data/DecisionTree.h"
+
+// JSON decision tree file format:
+//
+//   { "nodes": [
+//       { "id": 0, "feature": 4, "bias": 0.5, "left": 1, "right": 2 },
+//       { "id": 1, "feature": 0, "bias": 0.25, "left": 3 },
+//       ...
+//   ] }
+//
+// Node ids are level-order positions, so the children of node i are 2i + 1
+// ("left") and 2i + 2 ("right"), which is taken if the feature value is
+// greater than the bias. Nodes with a single child omit the other one.
+// Children without a node entry are result nodes, evaluators return their
+// ids.
+//
+// Returns invalid_argument for files that are no valid JSON or don't
+// describe a tree in this format.
+llvm::ErrorOr<DecisionTree> readDecisionTreeFile(std::string fileName);
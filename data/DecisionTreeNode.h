@@ -15,9 +15,12 @@ struct DecisionTreeNode {
   DecisionTreeNode &operator=(DecisionTreeNode &&) = default;
   DecisionTreeNode &operator=(const DecisionTreeNode &) = default;
 
+  // nodes with a single child pass NoNodeIdx for the missing one
   DecisionTreeNode(uint64_t nodeIdx, float bias, uint32_t dataSetFeatureIdx,
                    uint64_t zeroFalseChildIdx, uint64_t oneTrueChildIdx);
 
+  static constexpr uint64_t NoNodeIdx = 0xFFFFFFFFFFFFFFFF;
+
   friend bool operator==(const DecisionTreeNode &, const DecisionTreeNode &);
   friend bool operator!=(const DecisionTreeNode &, const DecisionTreeNode &);
 
@@ -26,6 +29,9 @@ struct DecisionTreeNode {
   bool hasLeftChild() const { return FalseChildNodeIdx != NoNodeIdx; }
   bool hasRightChild() const { return TrueChildNodeIdx != NoNodeIdx; }
 
+  // nodes with a single child continue there for both evaluations
+  bool hasSingleChild() const { return hasLeftChild() != hasRightChild(); }
+
   bool hasChildFor(NodeEvaluation evaluation) const;
   DecisionTreeNode getChildFor(NodeEvaluation evaluation,
                                DecisionSubtreeRef subtree) const;
@@ -48,7 +54,6 @@ private:
   uint64_t getChildIdxFor(NodeEvaluation evaluation) const;
 
   static constexpr uint32_t NoFeatureIdx = 0xFFFFFFFF;
-  static constexpr uint64_t NoNodeIdx = 0xFFFFFFFFFFFFFFFF;
   static constexpr float NoBias = std::numeric_limits<float>::quiet_NaN();
 
   friend class DecisionTree;
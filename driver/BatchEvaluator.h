@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "compiler/DataSetLayout.h"
+#include "driver/JitDriver.h"
+#include "driver/utility/ThreadPool.h"
+
+// Scores large row buffers with a compiled batch evaluator on a fixed thread
+// pool. The buffer is split into chunks that fit into the L2 cache. Each
+// worker starts with an equal share of chunks and, once it ran out of work,
+// steals chunks from the others, so slow chunks don't leave threads idle.
+// Results are written to the output buffer in place.
+class BatchEvaluator {
+public:
+  // hardware_concurrency() is 0 if the count is unknown
+  BatchEvaluator(unsigned threads =
+                     std::max(1u, std::thread::hardware_concurrency()),
+                 size_t chunkBytes = 256 * 1024)
+      : Pool(threads), ChunkBytes(chunkBytes) {}
+
+  // must match the layout the evaluator was compiled for
+  void setDataSetLayout(DataSetLayout layout) { Layout = layout; }
+
+  unsigned getNumThreads() const { return Pool.getNumThreads(); }
+
+  // stride and layout as for JitCompileResult::BatchEvaluatorFunction
+  void run(JitCompileResult::BatchEvaluator_f *evaluator, const float *data,
+           size_t stride, size_t numRows, uint64_t *out) {
+    runChunked(evaluator, data, stride, numRows, out);
+  }
+
+  void run(JitCompileResult::ScoreBatchEvaluator_f *evaluator,
+           const float *data, size_t stride, size_t numRows, float *out) {
+    runChunked(evaluator, data, stride, numRows, out);
+  }
+
+private:
+  ThreadPool Pool;
+  size_t ChunkBytes;
+  DataSetLayout Layout = DataSetLayout::RowMajor;
+
+  // chunk indices [Next, End) not yet claimed by any worker, one cache line
+  // each to avoid false sharing between the counters
+  struct alignas(64) WorkRange {
+    std::atomic<size_t> Next;
+    size_t End;
+  };
+
+  size_t getRowsPerChunk(size_t stride) const {
+    // column-major rows touch one value per feature column, but we don't
+    // know the number of features, so assume a cache line per row
+    size_t rowBytes =
+        (Layout == DataSetLayout::RowMajor) ? stride * sizeof(float) : 64;
+
+    return std::max<size_t>(1, ChunkBytes / rowBytes);
+  }
+
+  template <typename BatchEvaluator_f, typename Result_t>
+  void runChunked(BatchEvaluator_f *evaluator, const float *data,
+                  size_t stride, size_t numRows, Result_t *out) {
+    if (numRows == 0)
+      return;
+
+    size_t rowsPerChunk = getRowsPerChunk(stride);
+    size_t numChunks = (numRows + rowsPerChunk - 1) / rowsPerChunk;
+
+    // new only guarantees the alignment of max_align_t before C++17, so
+    // over-allocate and align the ranges manually
+    unsigned workers = Pool.getNumThreads();
+    size_t space = (workers + 1) * sizeof(WorkRange);
+    std::unique_ptr<char[]> storage(new char[space]);
+
+    void *aligned = storage.get();
+    std::align(alignof(WorkRange), workers * sizeof(WorkRange), aligned, space);
+    WorkRange *ranges = static_cast<WorkRange *>(aligned);
+
+    for (unsigned i = 0; i < workers; i++) {
+      new (&ranges[i]) WorkRange;
+      ranges[i].Next = numChunks * i / workers;
+      ranges[i].End = numChunks * (i + 1) / workers;
+    }
+
+    auto evaluateChunk = [&](size_t chunkIdx) {
+      size_t firstRow = chunkIdx * rowsPerChunk;
+      size_t rows = std::min(rowsPerChunk, numRows - firstRow);
+
+      size_t offset = (Layout == DataSetLayout::RowMajor)
+                          ? firstRow * stride
+                          : firstRow;
+
+      evaluator(data + offset, stride, rows, out + firstRow);
+    };
+
+    auto processRange = [&](WorkRange &range) {
+      size_t chunkIdx;
+      while ((chunkIdx = range.Next.fetch_add(1)) < range.End)
+        evaluateChunk(chunkIdx);
+    };
+
+    Pool.runOnAll([&](unsigned workerIdx) {
+      processRange(ranges[workerIdx]);
+
+      // steal from the others, starting with the next worker
+      for (unsigned i = 1; i < workers; i++)
+        processRange(ranges[(workerIdx + i) % workers]);
+    });
+  }
+};
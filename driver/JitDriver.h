@@ -1,6 +1,10 @@
 #pragma once
 
+#include <memory>
+#include <string>
+
 #include "compiler/DecisionTreeCompiler.h"
+#include "compiler/ObjectFileCache.h"
 #include "compiler/SimpleOrcJit.h"
 #include "data/DecisionTree.h"
 #include "driver/utility/AutoSetUpTearDownLLVM.h"
@@ -9,14 +13,99 @@ class CodeGeneratorSelector;
 
 struct JitCompileResult {
   using Evaluator_f = uint64_t(float*);
+  using BatchEvaluator_f = void(const float*, size_t, size_t, uint64_t*);
+
+  using ScoreEvaluator_f = float(float*);
+  using ScoreBatchEvaluator_f = void(const float*, size_t, size_t, float*);
+
+  JitCompileResult(CompileResult frontendResult, Evaluator_f *evalFunction,
+                   BatchEvaluator_f *batchEvalFunction)
+      : Tree(std::move(frontendResult.Tree)), EvaluatorFunction(evalFunction),
+        BatchEvaluatorFunction(batchEvalFunction),
+        Stats(std::move(frontendResult.Stats)),
+        Success(frontendResult.Success),
+        ErrorMessage(std::move(frontendResult.ErrorMessage)) {}
+
+  JitCompileResult(CompileResult frontendResult,
+                   ScoreEvaluator_f *evalFunction,
+                   ScoreBatchEvaluator_f *batchEvalFunction)
+      : Tree(std::move(frontendResult.Tree)),
+        ScoreEvaluatorFunction(evalFunction),
+        ScoreBatchEvaluatorFunction(batchEvalFunction),
+        Stats(std::move(frontendResult.Stats)),
+        Success(frontendResult.Success),
+        ErrorMessage(std::move(frontendResult.ErrorMessage)) {}
+
+  // shared with the caller if it passed a DecisionTreeHandle
+  DecisionTreeHandle Tree;
+
+  // return the result node index or, if the tree has leaf payloads, the
+  // class id of the result node (nullptr for trees with leaf scores)
+  Evaluator_f *EvaluatorFunction = nullptr;
+
+  // evaluate n data-sets in one call: (data, stride, n, out)
+  // stride is the row stride for DataSetLayout::RowMajor (default) and the
+  // column stride for DataSetLayout::ColumnMajor
+  BatchEvaluator_f *BatchEvaluatorFunction = nullptr;
+
+  // same for trees with leaf scores (nullptr otherwise)
+  ScoreEvaluator_f *ScoreEvaluatorFunction = nullptr;
+  ScoreBatchEvaluator_f *ScoreBatchEvaluatorFunction = nullptr;
+
+  // time per compile phase and code sizes, e.g. to find out which code
+  // generator or backend phase makes a model load slowly
+  CompileStats Stats;
+
+  // pass to JitDriver::unload() to release the code
+  SimpleOrcJit::ModuleHandle_t ModuleHandle;
+
+  // false if the compiler rejected the tree, nothing was submitted to the
+  // JIT and all function pointers are nullptr
+  bool Success;
+  std::string ErrorMessage;
+};
+
+struct JitForestCompileResult {
+  using Evaluator_f = JitCompileResult::Evaluator_f;
+  using ScoreEvaluator_f = JitCompileResult::ScoreEvaluator_f;
+
+  JitForestCompileResult(ForestCompileResult frontendResult,
+                         Evaluator_f *evalFunction)
+      : Trees(std::move(frontendResult.Trees)),
+        EvaluatorFunction(evalFunction),
+        Stats(std::move(frontendResult.Stats)),
+        Success(frontendResult.Success),
+        ErrorMessage(std::move(frontendResult.ErrorMessage)) {}
+
+  JitForestCompileResult(ForestCompileResult frontendResult,
+                         ScoreEvaluator_f *evalFunction)
+      : Trees(std::move(frontendResult.Trees)),
+        ScoreEvaluatorFunction(evalFunction),
+        Stats(std::move(frontendResult.Stats)),
+        Success(frontendResult.Success),
+        ErrorMessage(std::move(frontendResult.ErrorMessage)) {}
+
+  std::vector<DecisionTreeHandle> Trees;
 
-  JitCompileResult(CompileResult frontendResult, Evaluator_f *evalFunction)
-      : Tree(std::move(frontendResult.Tree)), EvaluatorFunction(evalFunction) {}
+  // returns the sum of the result node indices of all trees or, for trees
+  // with class id payloads, the class with the most votes
+  Evaluator_f *EvaluatorFunction = nullptr;
 
-  DecisionTree Tree;
-  Evaluator_f *EvaluatorFunction;
+  // returns the sum of the leaf scores of all trees
+  ScoreEvaluator_f *ScoreEvaluatorFunction = nullptr;
+
+  CompileStats Stats;
+  SimpleOrcJit::ModuleHandle_t ModuleHandle;
+
+  // see JitCompileResult
+  bool Success;
+  std::string ErrorMessage;
 };
 
+// Independent instances can compile on different threads at the same time.
+// Within one instance only the JIT's module submission and symbol lookups
+// are serialized. The frontend and its LLVMContext are not guarded, so
+// callers must not compile with one instance from several threads at once.
 class JitDriver {
   using ModuleHandle_t = SimpleOrcJit::ModuleHandle_t;
 
@@ -29,23 +118,182 @@ public:
     DecisionTreeFrontend.setCodegenSelector(std::move(codegenSel));
   }
 
+  void setDataSetLayout(DataSetLayout layout) {
+    DecisionTreeFrontend.setDataSetLayout(layout);
+  }
+
+  void setTreesPerFunction(uint32_t trees) {
+    DecisionTreeFrontend.setTreesPerFunction(trees);
+  }
+
+  void setOptimizationLevel(OptimizationLevel level) {
+    DecisionTreeFrontend.setOptimizationLevel(level);
+    JitBackend.setOptimizationLevel(level);
+  }
+
+  // compile trees deeper than splitLevel as independent subtree modules on
+  // the given number of threads
+  void setParallelCompile(uint8_t splitLevel, unsigned threads) {
+    DecisionTreeFrontend.setParallelSplitLevel(splitLevel);
+    JitBackend.setCompileThreads(threads);
+    LazySubtrees = false;
+  }
+
+  // compile the levels above splitLevel right away and each subtree below
+  // on the first call that reaches it, which may come from several threads
+  // at once
+  void setLazyCompile(uint8_t splitLevel) {
+    DecisionTreeFrontend.setParallelSplitLevel(splitLevel);
+    LazySubtrees = (splitLevel > 0);
+  }
+
+  // reuse compiled objects across processes, e.g. in the directory from
+  // DecisionTreeFactory::getCacheDir()
+  void enableObjectCache(std::string cacheDir) {
+    ObjectCache = std::make_unique<ObjectFileCache>(std::move(cacheDir));
+    DecisionTreeFrontend.setObjectCache(ObjectCache.get());
+    JitBackend.setObjectCache(ObjectCache.get());
+  }
+
+  // pack the code and read-only data of all models into shared huge-page
+  // regions, pass the same pool to several drivers to share them further
+  void setCodeMemoryPool(std::shared_ptr<CodeMemoryPool> pool) {
+    JitBackend.setCodeMemoryPool(std::move(pool));
+  }
+
   JitCompileResult run(DecisionTree decisionTree) {
+    return run(makeTreeHandle(std::move(decisionTree)));
+  }
+
+  // the result shares the tree instead of holding a copy, so one instance
+  // serves the compiler, interpreters and results on all threads
+  JitCompileResult run(DecisionTreeHandle decisionTree) {
+    using Evaluator_f = JitCompileResult::Evaluator_f;
+    using BatchEvaluator_f = JitCompileResult::BatchEvaluator_f;
+
     CompileResult frontendResult =
         DecisionTreeFrontend.compile(std::move(decisionTree));
 
+    if (!frontendResult.Success)
+      return JitCompileResult(std::move(frontendResult),
+                              static_cast<Evaluator_f *>(nullptr),
+                              static_cast<BatchEvaluator_f *>(nullptr));
+
     std::string entryFnName = frontendResult.EvaluatorFunctionName;
-    assert(frontendResult.Module->getFunction(entryFnName) != nullptr);
+    std::string batchFnName = frontendResult.BatchEvaluatorFunctionName;
+    assert(frontendResult.FromObjectCache ||
+           frontendResult.Module->getFunction(entryFnName) != nullptr);
+    assert(frontendResult.FromObjectCache ||
+           frontendResult.Module->getFunction(batchFnName) != nullptr);
 
-    ModuleHandle_t module = JitBackend.submitModule(
-        std::move(frontendResult.Module));
+    LeafPayloadKind payloadKind = frontendResult.Tree->getLeafPayloadKind();
+    ModuleHandle_t module = submit(std::move(frontendResult.Module),
+                                   std::move(frontendResult.SubtreeModules),
+                                   std::move(frontendResult.SubtreeContexts),
+                                   frontendResult.FromObjectCache,
+                                   frontendResult.Stats);
 
-    return JitCompileResult(
+    if (payloadKind == LeafPayloadKind::Score) {
+      using ScoreEvaluator_f = JitCompileResult::ScoreEvaluator_f;
+      using ScoreBatchEvaluator_f = JitCompileResult::ScoreBatchEvaluator_f;
+
+      JitCompileResult result(
+          std::move(frontendResult),
+          JitBackend.getFnPtrIn<ScoreEvaluator_f>(module, entryFnName),
+          JitBackend.getFnPtrIn<ScoreBatchEvaluator_f>(module, batchFnName));
+
+      result.ModuleHandle = module;
+      return result;
+    }
+
+    JitCompileResult result(
         std::move(frontendResult),
-        JitBackend.getFnPtrIn<JitCompileResult::Evaluator_f>(module, entryFnName));
+        JitBackend.getFnPtrIn<Evaluator_f>(module, entryFnName),
+        JitBackend.getFnPtrIn<BatchEvaluator_f>(module, batchFnName));
+
+    result.ModuleHandle = module;
+    return result;
   }
 
+  JitForestCompileResult run(std::vector<DecisionTree> decisionTrees) {
+    std::vector<DecisionTreeHandle> handles;
+    handles.reserve(decisionTrees.size());
+
+    for (DecisionTree &tree : decisionTrees)
+      handles.push_back(makeTreeHandle(std::move(tree)));
+
+    return run(std::move(handles));
+  }
+
+  JitForestCompileResult run(std::vector<DecisionTreeHandle> decisionTrees) {
+    using Evaluator_f = JitForestCompileResult::Evaluator_f;
+
+    ForestCompileResult frontendResult =
+        DecisionTreeFrontend.compile(std::move(decisionTrees));
+
+    if (!frontendResult.Success)
+      return JitForestCompileResult(std::move(frontendResult),
+                                    static_cast<Evaluator_f *>(nullptr));
+
+    std::string entryFnName = frontendResult.EvaluatorFunctionName;
+    assert(frontendResult.FromObjectCache ||
+           frontendResult.Module->getFunction(entryFnName) != nullptr);
+
+    LeafPayloadKind payloadKind =
+        frontendResult.Trees.front()->getLeafPayloadKind();
+    ModuleHandle_t module = submit(std::move(frontendResult.Module), {}, {},
+                                   frontendResult.FromObjectCache,
+                                   frontendResult.Stats);
+
+    if (payloadKind == LeafPayloadKind::Score) {
+      using ScoreEvaluator_f = JitForestCompileResult::ScoreEvaluator_f;
+
+      JitForestCompileResult result(
+          std::move(frontendResult),
+          JitBackend.getFnPtrIn<ScoreEvaluator_f>(module, entryFnName));
+
+      result.ModuleHandle = module;
+      return result;
+    }
+
+    JitForestCompileResult result(
+        std::move(frontendResult),
+        JitBackend.getFnPtrIn<Evaluator_f>(module, entryFnName));
+
+    result.ModuleHandle = module;
+    return result;
+  }
+
+  // releases the code and data of a result's module, its function pointers
+  // must not be called anymore
+  void unload(ModuleHandle_t module) { JitBackend.removeModule(module); }
+
 private:
+  std::unique_ptr<ObjectFileCache> ObjectCache;
   AutoSetUpTearDownLLVM LLVM;
   DecisionTreeCompiler DecisionTreeFrontend;
   SimpleOrcJit JitBackend;
+  bool LazySubtrees = false;
+
+  // the subtree modules' contexts stay alive until this returns or, for lazy
+  // compilation, until the JIT compiled the modules
+  ModuleHandle_t
+  submit(std::unique_ptr<llvm::Module> module,
+         std::vector<std::unique_ptr<llvm::Module>> subtrees,
+         std::vector<std::unique_ptr<llvm::LLVMContext>> subtreeContexts,
+         bool fromObjectCache, CompileStats &stats) {
+    if (fromObjectCache)
+      return JitBackend.submitCachedModule(std::move(module), &stats);
+
+    if (!subtrees.empty() && LazySubtrees)
+      return JitBackend.submitModuleLazy(std::move(module), std::move(subtrees),
+                                         std::move(subtreeContexts), &stats);
+
+    if (!subtrees.empty()) {
+      subtrees.push_back(std::move(module));
+      return JitBackend.submitModulesParallel(std::move(subtrees), &stats);
+    }
+
+    return JitBackend.submitModule(std::move(module), &stats);
+  }
 };
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+
+class CodeGeneratorSelector;
+
+// A compiled tree that unloads its module when the last reference is gone.
+// The model shares ownership of the driver that compiled it.
+class CompiledModel {
+public:
+  CompiledModel(std::shared_ptr<JitDriver> jit, JitCompileResult result)
+      : Jit(std::move(jit)), Result(std::move(result)) {}
+
+  ~CompiledModel() { Jit->unload(Result.ModuleHandle); }
+
+  CompiledModel(const CompiledModel &) = delete;
+  CompiledModel &operator=(const CompiledModel &) = delete;
+  CompiledModel(CompiledModel &&) = delete;
+  CompiledModel &operator=(CompiledModel &&) = delete;
+
+  const JitCompileResult &getCompileResult() const { return Result; }
+  const std::shared_ptr<JitDriver> &getJitDriver() const { return Jit; }
+
+private:
+  std::shared_ptr<JitDriver> Jit;
+  JitCompileResult Result;
+};
+
+// Maps model keys to compiled trees that can be replaced while other threads
+// evaluate them. Callers hold on to the shared_ptr from get() for as long as
+// they call into the model. A replaced model is unloaded once its last
+// holder released it, so in-flight calls always finish on the old code and
+// code memory doesn't grow with the number of replacements.
+//
+// Each model is compiled by its own JitDriver. LLVMContexts never release
+// the types and constants uniqued in them, so a single long-lived compiler
+// would grow with every replacement. A model's context is destroyed
+// together with the model.
+class ModelRegistry {
+public:
+  using Model_t = std::shared_ptr<const CompiledModel>;
+
+  ModelRegistry(std::shared_ptr<CodeGeneratorSelector> codegenSel = nullptr)
+      : CodegenSelector(std::move(codegenSel)) {}
+
+  // compiles the tree and atomically replaces the model for the key,
+  // returns the new model or nullptr if the tree can't be compiled, which
+  // keeps the previous model in place
+  Model_t replace(const std::string &key, DecisionTree tree) {
+    return replace(key, makeTreeHandle(std::move(tree)));
+  }
+
+  Model_t replace(const std::string &key, DecisionTreeHandle tree) {
+    Model_t model;
+    {
+      // code generators are shared between the drivers and not thread-safe
+      std::lock_guard<std::mutex> lock(CompileMutex);
+      auto jit = std::make_shared<JitDriver>();
+      if (CodegenSelector)
+        jit->setCodegenSelector(CodegenSelector);
+
+      JitCompileResult result = jit->run(std::move(tree));
+      if (!result.Success)
+        return nullptr;
+
+      model = std::make_shared<CompiledModel>(std::move(jit),
+                                              std::move(result));
+    }
+
+    Model_t previous;
+    {
+      std::lock_guard<std::mutex> lock(ModelsMutex);
+      previous = std::move(Models[key]);
+      Models[key] = model;
+    }
+
+    // the previous model gets unloaded here, unless readers still hold it
+    return model;
+  }
+
+  // returns nullptr for unknown keys
+  Model_t get(const std::string &key) const {
+    std::lock_guard<std::mutex> lock(ModelsMutex);
+    auto it = Models.find(key);
+    return (it == Models.end()) ? nullptr : it->second;
+  }
+
+  // the model gets unloaded once no reader holds it anymore
+  bool remove(const std::string &key) {
+    Model_t previous;
+    {
+      std::lock_guard<std::mutex> lock(ModelsMutex);
+      auto it = Models.find(key);
+      if (it == Models.end())
+        return false;
+
+      previous = std::move(it->second);
+      Models.erase(it);
+    }
+
+    return true;
+  }
+
+private:
+  std::shared_ptr<CodeGeneratorSelector> CodegenSelector;
+  std::mutex CompileMutex;
+
+  mutable std::mutex ModelsMutex;
+  std::unordered_map<std::string, Model_t> Models;
+};
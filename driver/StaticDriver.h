@@ -9,8 +9,9 @@
 #include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/Path.h>
 #include <llvm/Support/raw_ostream.h>
-#include <llvm/Transforms/Scalar.h>
+#include <llvm/Transforms/IPO.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
+#include <llvm/Transforms/Scalar.h>
 #include <llvm/IR/LegacyPassManager.h>
 
 #include "codegen/CodeGeneratorSelector.h"
@@ -141,6 +142,7 @@ private:
     PMBuilder.SLPVectorize = true;
     PMBuilder.VerifyInput = true;
     PMBuilder.VerifyOutput = true;
+    PMBuilder.Inliner = llvm::createAlwaysInlinerPass();
 
     llvm::legacy::FunctionPassManager perFunctionPasses(module);
     PMBuilder.populateFunctionPassManager(perFunctionPasses);
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "data/DecisionTree.h"
+#include "data/DecisionTreeFile.h"
+#include "driver/BatchEvaluator.h"
+#include "driver/JitDriver.h"
+#include "driver/utility/BlockingQueue.h"
+#include "driver/utility/RowReader.h"
+
+// Evaluates a compiled tree for a stream of rows that may be much larger
+// than the available memory. Rows are read in fixed-size chunks into a small
+// set of reusable buffers. While the worker threads evaluate one chunk, a
+// reader thread fills the next one and a writer thread prints the results of
+// the previous one, so evaluation doesn't wait for I/O and memory use stays
+// bounded by the number of buffers.
+class StreamDriver {
+  struct Chunk {
+    std::vector<float> Rows;
+    std::vector<uint64_t> Results;
+    size_t NumRows = 0; // 0 marks the end of the stream
+  };
+
+public:
+  // returns false if any input or output failed
+  bool run() {
+    llvm::ErrorOr<DecisionTree> decisionTree =
+        readDecisionTreeFile(TreeFileName);
+
+    if (!decisionTree) {
+      llvm::errs() << "Cannot read decision tree from file ";
+      llvm::errs() << TreeFileName << ": ";
+      llvm::errs() << decisionTree.getError().message() << "\n";
+      llvm::errs() << "Aborting\n";
+      return false;
+    }
+
+    if (!readsOnlyKnownFeatures(*decisionTree)) {
+      llvm::errs() << "Decision tree reads features beyond the ";
+      llvm::errs() << Features << " features per row\n";
+      llvm::errs() << "Aborting\n";
+      return false;
+    }
+
+    std::ifstream dataFile;
+    std::istream *dataStream = &std::cin;
+
+    if (DataFileName != "-") {
+      auto mode = ReadCsv ? std::ios::in : std::ios::in | std::ios::binary;
+      dataFile.open(DataFileName, mode);
+      if (!dataFile) {
+        llvm::errs() << "Cannot read data from file ";
+        llvm::errs() << DataFileName << "\n";
+        llvm::errs() << "Aborting\n";
+        return false;
+      }
+      dataStream = &dataFile;
+    }
+
+    std::unique_ptr<llvm::raw_fd_ostream> outputFile;
+    llvm::raw_fd_ostream *out = &llvm::outs();
+
+    if (!OutputFileName.empty()) {
+      std::error_code EC;
+      outputFile = std::make_unique<llvm::raw_fd_ostream>(
+          OutputFileName, EC, llvm::sys::fs::F_Text);
+
+      if (EC) {
+        llvm::errs() << "Cannot open output file ";
+        llvm::errs() << OutputFileName << " for writing\n";
+        llvm::errs() << "Aborting\n";
+        return false;
+      }
+      out = outputFile.get();
+    }
+
+    JitCompileResult compiled = Jit.run(std::move(*decisionTree));
+    if (!compiled.Success) {
+      llvm::errs() << "Cannot compile decision tree: ";
+      llvm::errs() << compiled.ErrorMessage << "\n";
+      llvm::errs() << "Aborting\n";
+      return false;
+    }
+
+    std::unique_ptr<RowReader> reader;
+    if (ReadCsv)
+      reader = std::make_unique<CsvRowReader>(*dataStream, Features);
+    else
+      reader = std::make_unique<BinaryRowReader>(*dataStream, Features);
+
+    streamChunks(compiled.BatchEvaluatorFunction, *reader, *out);
+
+    // closing flushes the rest, raw_fd_ostream aborts in its destructor on
+    // errors that were not cleared
+    if (outputFile)
+      outputFile->close();
+
+    if (out->has_error()) {
+      llvm::errs() << "Error writing results to ";
+      llvm::errs() << (outputFile ? OutputFileName : "stdout") << "\n";
+      llvm::errs() << "Aborting\n";
+      out->clear_error();
+      return false;
+    }
+
+    if (reader->hasError()) {
+      llvm::errs() << "Error reading data: " << reader->getError() << "\n";
+      llvm::errs() << "Aborting\n";
+      return false;
+    }
+
+    return true;
+  }
+
+  void setReadCsv() { ReadCsv = true; }
+  void setFeatures(uint32_t features) { Features = features; }
+  void setRowsPerChunk(size_t rows) { RowsPerChunk = rows; }
+  void setThreads(unsigned threads) { Threads = threads; }
+
+  void setTreeFileName(std::string fileName) {
+    TreeFileName = std::move(fileName);
+  }
+
+  void setDataFileName(std::string fileName) {
+    DataFileName = std::move(fileName);
+  }
+
+  void setOutputFileName(std::string fileName) {
+    OutputFileName = std::move(fileName);
+  }
+
+  bool isConfigurationComplete() const {
+    return !TreeFileName.empty() && Features > 0;
+  }
+
+private:
+  JitDriver Jit;
+
+  std::string TreeFileName;
+  std::string DataFileName = "-"; // stdin
+  std::string OutputFileName;     // stdout if empty
+
+  uint32_t Features = 0;
+  size_t RowsPerChunk = 65536;
+  unsigned Threads = std::max(1u, std::thread::hardware_concurrency());
+  bool ReadCsv = false;
+
+  // one being read, one being evaluated, one being written
+  static constexpr int NumChunkBuffers = 3;
+
+  bool readsOnlyKnownFeatures(const DecisionTree &tree) const {
+    for (uint64_t slot = 0; slot < tree.getNumNodeSlots(); slot++)
+      if (tree.isNodeSlotUsed(slot) &&
+          !tree.getNodeInSlot(slot).isImplicit() &&
+          tree.getNodeInSlot(slot).getFeatureIdx() >= Features)
+        return false;
+
+    return true;
+  }
+
+  // stops reading once writing failed, the remaining chunks pass the writer
+  // without output
+  void streamChunks(JitCompileResult::BatchEvaluator_f *evaluatorFn,
+                    RowReader &reader, llvm::raw_fd_ostream &out) {
+    std::atomic<bool> outputFailed(false);
+    std::vector<Chunk> chunks(NumChunkBuffers);
+    BlockingQueue<Chunk *> freeChunks;
+    BlockingQueue<Chunk *> readChunks;
+    BlockingQueue<Chunk *> evaluatedChunks;
+
+    for (Chunk &chunk : chunks) {
+      chunk.Rows.resize(RowsPerChunk * Features);
+      chunk.Results.resize(RowsPerChunk);
+      freeChunks.push(&chunk);
+    }
+
+    std::thread readerThread([&]() {
+      while (true) {
+        Chunk *chunk = freeChunks.pop();
+        chunk->NumRows =
+            outputFailed ? 0 : reader.read(chunk->Rows.data(), RowsPerChunk);
+        readChunks.push(chunk);
+
+        if (chunk->NumRows == 0)
+          return;
+      }
+    });
+
+    std::thread writerThread([&]() {
+      while (true) {
+        Chunk *chunk = evaluatedChunks.pop();
+        if (chunk->NumRows == 0)
+          return;
+
+        if (!outputFailed) {
+          for (size_t i = 0; i < chunk->NumRows; i++)
+            out << chunk->Results[i] << "\n";
+
+          out.flush();
+          outputFailed = out.has_error();
+        }
+
+        freeChunks.push(chunk);
+      }
+    });
+
+    BatchEvaluator evaluator(Threads);
+    while (true) {
+      Chunk *chunk = readChunks.pop();
+      if (chunk->NumRows > 0)
+        evaluator.run(evaluatorFn, chunk->Rows.data(), Features,
+                      chunk->NumRows, chunk->Results.data());
+
+      evaluatedChunks.push(chunk);
+      if (chunk->NumRows == 0)
+        break;
+    }
+
+    readerThread.join();
+    writerThread.join();
+  }
+};
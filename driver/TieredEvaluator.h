@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "data/CompactDecisionTree.h"
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+#include "driver/utility/Interpreter.h"
+
+class CodeGeneratorSelector;
+
+// Serves a tree through the Interpreter right away and compiles it on a
+// background thread. Once the JIT'ed evaluator is available, run() switches
+// over to it. Calls before and after the switch return the same results.
+//
+// With fastTierFirst, the background thread first compiles the tree with
+// OptimizationLevel::Fast, switches to that code and then recompiles with
+// OptimizationLevel::Max. The fast tier's code stays loaded, because calls
+// may still be running in it.
+class TieredEvaluator {
+  using Evaluator_f = JitCompileResult::Evaluator_f;
+  using ScoreEvaluator_f = JitCompileResult::ScoreEvaluator_f;
+
+public:
+  TieredEvaluator(DecisionTree tree,
+                  std::shared_ptr<CodeGeneratorSelector> codegenSel = nullptr,
+                  bool fastTierFirst = false)
+      : TieredEvaluator(makeTreeHandle(std::move(tree)), std::move(codegenSel),
+                        fastTierFirst) {}
+
+  // the interpreter tier and both compiles share the tree
+  TieredEvaluator(DecisionTreeHandle tree,
+                  std::shared_ptr<CodeGeneratorSelector> codegenSel = nullptr,
+                  bool fastTierFirst = false)
+      : Tree(std::move(tree)), CompactTree(*Tree) {
+    if (fastTierFirst) {
+      FastJit = std::make_unique<JitDriver>();
+      FastJit->setOptimizationLevel(OptimizationLevel::Fast);
+      if (codegenSel)
+        FastJit->setCodegenSelector(codegenSel);
+    }
+
+    Jit.setOptimizationLevel(OptimizationLevel::Max);
+    if (codegenSel)
+      Jit.setCodegenSelector(std::move(codegenSel));
+
+    Compilation = std::thread(&TieredEvaluator::compile, this, Tree);
+  }
+
+  ~TieredEvaluator() { waitForCompilation(); }
+
+  TieredEvaluator(const TieredEvaluator &) = delete;
+  TieredEvaluator &operator=(const TieredEvaluator &) = delete;
+  TieredEvaluator(TieredEvaluator &&) = delete;
+  TieredEvaluator &operator=(TieredEvaluator &&) = delete;
+
+  // returns the result node index or, if the tree has class id payloads,
+  // the class id of the result node
+  uint64_t run(float *dataSet) {
+    assert(Tree->getLeafPayloadKind() != LeafPayloadKind::Score);
+    if (Evaluator_f *fp = EvaluatorFunction.load(std::memory_order_acquire))
+      return fp(dataSet);
+
+    uint64_t resultIdx = Interp.run(CompactTree, dataSet);
+    if (Tree->getLeafPayloadKind() == LeafPayloadKind::ClassId)
+      return Tree->getLeafClassId(resultIdx);
+
+    return resultIdx;
+  }
+
+  // returns the leaf score of the result node
+  float runScore(float *dataSet) {
+    assert(Tree->getLeafPayloadKind() == LeafPayloadKind::Score);
+    if (ScoreEvaluator_f *fp =
+            ScoreEvaluatorFunction.load(std::memory_order_acquire))
+      return fp(dataSet);
+
+    return Tree->getLeafScore(Interp.run(CompactTree, dataSet));
+  }
+
+  // true once the final tier is in use
+  bool isCompiled() const { return Compiled.load(std::memory_order_acquire); }
+
+  // call from the owning thread only
+  void waitForCompilation() {
+    if (Compilation.joinable())
+      Compilation.join();
+  }
+
+private:
+  DecisionTreeHandle Tree;
+  CompactDecisionTree CompactTree;
+  Interpreter Interp;
+  JitDriver Jit;
+  std::unique_ptr<JitDriver> FastJit;
+  std::thread Compilation;
+
+  std::atomic<Evaluator_f *> EvaluatorFunction{nullptr};
+  std::atomic<ScoreEvaluator_f *> ScoreEvaluatorFunction{nullptr};
+  std::atomic<bool> Compiled{false};
+
+  // trees the compiler rejects stay in the interpreter tier
+  void compile(DecisionTreeHandle tree) {
+    if (FastJit) {
+      JitCompileResult fastResult = FastJit->run(tree);
+      if (!fastResult.Success)
+        return;
+
+      publish(fastResult);
+    }
+
+    JitCompileResult result = Jit.run(std::move(tree));
+    if (!result.Success)
+      return;
+
+    publish(result);
+    Compiled.store(true, std::memory_order_release);
+  }
+
+  void publish(const JitCompileResult &result) {
+    // the release stores publish the finalized code to all readers
+    EvaluatorFunction.store(result.EvaluatorFunction,
+                            std::memory_order_release);
+    ScoreEvaluatorFunction.store(result.ScoreEvaluatorFunction,
+                                 std::memory_order_release);
+  }
+};
@@ -13,7 +13,7 @@ AutoSetUpTearDownLLVM::AutoSetUpTearDownLLVM() {
   InitializeNativeTargetAsmPrinter();
   InitializeNativeTargetAsmParser();
 
-  TM = EngineBuilder().selectTarget();
+  TM.reset(EngineBuilder().selectTarget());
 }
 
 AutoSetUpTearDownLLVM::StaticShutDownHelper::~StaticShutDownHelper() {
@@ -1,18 +1,19 @@
 #pragma once
 
+#include <memory>
 #include <mutex>
 #include <llvm/Target/TargetMachine.h>
 
 struct AutoSetUpTearDownLLVM {
   AutoSetUpTearDownLLVM();
-  llvm::TargetMachine *getTargetMachine() const { return TM; }
+  llvm::TargetMachine *getTargetMachine() const { return TM.get(); }
 
 private:
   struct StaticShutDownHelper {
     ~StaticShutDownHelper();
   };
 
-  llvm::TargetMachine *TM;
+  std::unique_ptr<llvm::TargetMachine> TM;
   static std::mutex NoRaceInGlobalInit;
   static StaticShutDownHelper StaticShutdown;
 };
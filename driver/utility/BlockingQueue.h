@@ -0,0 +1,33 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Minimal multi-producer multi-consumer queue. pop() blocks until an item
+// is available.
+template <typename T>
+class BlockingQueue {
+public:
+  void push(T item) {
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      Items.push_back(std::move(item));
+    }
+    ItemAvailable.notify_one();
+  }
+
+  T pop() {
+    std::unique_lock<std::mutex> lock(Mutex);
+    ItemAvailable.wait(lock, [this]() { return !Items.empty(); });
+
+    T item = std::move(Items.front());
+    Items.pop_front();
+    return item;
+  }
+
+private:
+  std::mutex Mutex;
+  std::condition_variable ItemAvailable;
+  std::deque<T> Items;
+};
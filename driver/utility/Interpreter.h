@@ -1,5 +1,6 @@
 #pragma once
 
+#include "data/CompactDecisionTree.h"
 #include "data/DecisionTree.h"
 #include "data/DecisionTreeNode.h"
 
@@ -11,9 +12,12 @@ public:
 
     while (!nodePtr->isImplicit()) {
       float featureValue = *(dataSet + nodePtr->getFeatureIdx());
-      uint64_t childIdx = featureValue > nodePtr->getFeatureBias()
-                          ? nodePtr->getRightChildIdx()
-                          : nodePtr->getLeftChildIdx();
+      bool right = nodePtr->hasSingleChild()
+                   ? nodePtr->hasRightChild()
+                   : featureValue > nodePtr->getFeatureBias();
+
+      uint64_t childIdx = right ? nodePtr->getRightChildIdx()
+                                : nodePtr->getLeftChildIdx();
 
       nodePtr = tree.getNodePtr(childIdx);
     }
@@ -30,9 +34,31 @@ public:
                           ? NodeEvaluation::ContinueOneRight
                           : NodeEvaluation::ContinueZeroLeft;
 
+      if (!node.hasChildFor(eval))
+        eval = node.hasLeftChild() ? NodeEvaluation::ContinueZeroLeft
+                                   : NodeEvaluation::ContinueOneRight;
+
       node = tree.getChildNodeFor(std::move(node), eval);
     }
 
     return node.getIdx();
   }
+
+  // returns the result node index like run() on the original tree, works
+  // for all layouts of the compact tree
+  uint64_t run(const CompactDecisionTree &tree, float *dataSet) {
+    const CompactDecisionTree::Node *nodes = tree.getNodes();
+    const CompactDecisionTree::Node *nodePtr = nodes;
+
+    while (!nodePtr->isResult()) {
+      float featureValue = *(dataSet + nodePtr->FeatureIdx);
+      uint32_t childIdx = nodePtr->FirstChildIdx +
+                          (featureValue > nodePtr->Bias
+                               ? nodePtr->RightChildOffset : 0);
+
+      nodePtr = nodes + childIdx;
+    }
+
+    return nodePtr->getResultIdx();
+  }
 };
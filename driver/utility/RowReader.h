@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <string>
+
+// Reads data-set rows of a fixed number of features from a stream into a
+// caller-provided buffer. A read that returns 0 rows signals the end of the
+// input or an error. A read that hits an error returns the rows before it,
+// so callers must check hasError() once the input ended.
+class RowReader {
+public:
+  RowReader(std::istream &in, uint32_t features)
+      : In(in), Features(features) {}
+  virtual ~RowReader() = default;
+
+  RowReader(RowReader &&) = delete;
+  RowReader(const RowReader &) = delete;
+  RowReader &operator=(RowReader &&) = delete;
+  RowReader &operator=(const RowReader &) = delete;
+
+  // buffer must hold maxRows * features values
+  virtual size_t read(float *buffer, size_t maxRows) = 0;
+
+  bool hasError() const { return !Error.empty(); }
+  const std::string &getError() const { return Error; }
+
+protected:
+  std::istream &In;
+  uint32_t Features;
+  std::string Error;
+};
+
+// Raw 32 bit floats in host byte order, row after row.
+class BinaryRowReader : public RowReader {
+public:
+  using RowReader::RowReader;
+
+  size_t read(float *buffer, size_t maxRows) override {
+    size_t rowBytes = Features * sizeof(float);
+    In.read(reinterpret_cast<char *>(buffer), maxRows * rowBytes);
+
+    size_t bytes = In.gcount();
+    if (bytes % rowBytes != 0)
+      Error = "Input ends with incomplete row";
+
+    return bytes / rowBytes;
+  }
+};
+
+// One row per line, values separated by commas. Empty lines are skipped.
+class CsvRowReader : public RowReader {
+public:
+  using RowReader::RowReader;
+
+  size_t read(float *buffer, size_t maxRows) override {
+    if (hasError())
+      return 0;
+
+    size_t rows = 0;
+    while (rows < maxRows && std::getline(In, Line)) {
+      LineNumber++;
+      if (!Line.empty() && Line.back() == '\r')
+        Line.pop_back();
+
+      if (Line.empty())
+        continue;
+
+      if (!parseLine(buffer + rows * Features))
+        break;
+
+      rows++;
+    }
+
+    return rows;
+  }
+
+private:
+  std::string Line;
+  uint64_t LineNumber = 0;
+
+  bool parseLine(float *row) {
+    const char *pos = Line.c_str();
+
+    for (uint32_t i = 0; i < Features; i++) {
+      char *end;
+      row[i] = std::strtof(pos, &end);
+
+      bool separatorOk = (i + 1 < Features) ? *end == ',' : *end == '\0';
+      if (end == pos || !separatorOk) {
+        Error = "Line " + std::to_string(LineNumber) + ": expected " +
+                std::to_string(Features) + " comma-separated values";
+        return false;
+      }
+
+      pos = end + 1;
+    }
+
+    return true;
+  }
+};
@@ -0,0 +1,63 @@
+#include "driver/utility/ThreadPool.h"
+
+#include <cassert>
+
+ThreadPool::ThreadPool(unsigned threads) {
+  assert(threads > 0);
+  Workers.reserve(threads);
+
+  for (unsigned i = 0; i < threads; i++)
+    Workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    ShutDown = true;
+  }
+
+  JobAvailable.notify_all();
+  for (std::thread &worker : Workers)
+    worker.join();
+}
+
+void ThreadPool::runOnAll(Job_f job) {
+  std::lock_guard<std::mutex> runLock(RunOnAllMutex);
+  std::unique_lock<std::mutex> lock(Mutex);
+
+  Job = std::move(job);
+  PendingWorkers = Workers.size();
+  JobGeneration++;
+
+  JobAvailable.notify_all();
+  JobDone.wait(lock, [this]() { return PendingWorkers == 0; });
+
+  Job = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned workerIdx) {
+  uint64_t lastGeneration = 0;
+
+  while (true) {
+    Job_f *job;
+    {
+      std::unique_lock<std::mutex> lock(Mutex);
+      JobAvailable.wait(lock, [&]() {
+        return ShutDown || JobGeneration != lastGeneration;
+      });
+
+      if (ShutDown)
+        return;
+
+      lastGeneration = JobGeneration;
+      job = &Job;
+    }
+
+    // Job stays alive until all workers are done
+    (*job)(workerIdx);
+
+    std::lock_guard<std::mutex> lock(Mutex);
+    if (--PendingWorkers == 0)
+      JobDone.notify_one();
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for fork-join style jobs. A job runs once on
+// every worker and runOnAll() returns when all of them are done. Workers
+// distribute the actual work among themselves.
+class ThreadPool {
+public:
+  using Job_f = std::function<void(unsigned workerIdx)>;
+
+  // hardware_concurrency() is 0 if the count is unknown
+  ThreadPool(unsigned threads =
+                 std::max(1u, std::thread::hardware_concurrency()));
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool &&) = delete;
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(ThreadPool &&) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  unsigned getNumThreads() const { return Workers.size(); }
+
+  void runOnAll(Job_f job);
+
+private:
+  std::vector<std::thread> Workers;
+
+  std::mutex RunOnAllMutex; // one job at a time
+  std::mutex Mutex;
+  std::condition_variable JobAvailable;
+  std::condition_variable JobDone;
+
+  Job_f Job;
+  uint64_t JobGeneration = 0;
+  unsigned PendingWorkers = 0;
+  bool ShutDown = false;
+
+  void workerLoop(unsigned workerIdx);
+};
@@ -1,8 +1,17 @@
 #include <benchmark/benchmark.h>
 
+#include "benchmark/BenchmarkBatchEvaluation.h"
+#include "benchmark/BenchmarkCompileTime.h"
+#include "benchmark/BenchmarkConcurrentLoading.h"
+#include "benchmark/BenchmarkForestEvaluation.h"
 #include "benchmark/BenchmarkInterpreter.h"
 #include "benchmark/BenchmarkSingleCodegen.h"
 #include "benchmark/BenchmarkMixedCodegen.h"
+#include "benchmark/BenchmarkMultiThreadedBatch.h"
+#include "benchmark/BenchmarkObjectCache.h"
+#include "benchmark/BenchmarkOptimizationLevels.h"
+#include "benchmark/BenchmarkParallelCompilation.h"
+#include "benchmark/BenchmarkPooledCodeMemory.h"
 #include "benchmark/Shared.h"
 
 int BenchmarkId = 0;
@@ -26,15 +35,102 @@ void addBenchmark(Benchmark_f lambda, const char *name, int depth, int features)
   benchmark->MinTime(3.0)->Threads(2)->UseRealTime();
 }
 
+template <class Benchmark_f>
+void addBatchBenchmark(Benchmark_f lambda, const char *name, int depth,
+                       int features, int rows) {
+  auto caption = makeBenchmarkName(name, depth, features);
+  caption += std::to_string(rows) + " rows";
+
+  auto benchmark = ::benchmark::RegisterBenchmark(caption.data(), lambda,
+                                                  BenchmarkId++, depth,
+                                                  features, rows);
+  benchmark->MinTime(3.0)->Threads(2)->UseRealTime();
+}
+
+template <class Benchmark_f>
+void addForestBenchmark(Benchmark_f lambda, const char *name, int depth,
+                        int features, int trees) {
+  auto caption = makeBenchmarkName(name, depth, features);
+  caption += std::to_string(trees) + " trees";
+
+  auto benchmark = ::benchmark::RegisterBenchmark(caption.data(), lambda,
+                                                  BenchmarkId++, depth,
+                                                  features, trees);
+  benchmark->MinTime(3.0)->Threads(2)->UseRealTime();
+}
+
+template <class Benchmark_f>
+void addThreadedBatchBenchmark(Benchmark_f lambda, const char *name, int depth,
+                               int features, int rows, int threads) {
+  auto caption = makeBenchmarkName(name, depth, features);
+  caption += std::to_string(rows) + " rows ";
+  caption += std::to_string(threads) + " threads";
+
+  // the benchmark runs its own threads
+  auto benchmark = ::benchmark::RegisterBenchmark(caption.data(), lambda,
+                                                  BenchmarkId++, depth,
+                                                  features, rows, threads);
+  benchmark->MinTime(3.0)->UseRealTime();
+}
+
+template <class Benchmark_f>
+void addStartupBenchmark(Benchmark_f lambda, const char *name, int depth,
+                         int features) {
+  auto caption = makeBenchmarkName(name, depth, features);
+
+  // each iteration sets up LLVM and compiles or loads a whole module
+  auto benchmark = ::benchmark::RegisterBenchmark(caption.data(), lambda,
+                                                  BenchmarkId++, depth,
+                                                  features);
+  benchmark->MinTime(3.0)->UseRealTime();
+}
+
+template <class Benchmark_f>
+void addConcurrentLoadingBenchmark(Benchmark_f lambda, const char *name,
+                                   int depth, int features, int threads) {
+  auto caption = makeBenchmarkName(name, depth, features);
+  caption += std::to_string(threads) + " threads";
+
+  // the benchmark runs its own threads
+  auto benchmark = ::benchmark::RegisterBenchmark(caption.data(), lambda,
+                                                  BenchmarkId++, depth,
+                                                  features, threads);
+  benchmark->MinTime(3.0)->UseRealTime();
+}
+
+template <class Benchmark_f>
+void addMultiModelBenchmark(Benchmark_f lambda, const char *name, int depth,
+                            int features, int models) {
+  auto caption = makeBenchmarkName(name, depth, features);
+  caption += std::to_string(models) + " models";
+
+  // hardware counters are read for the benchmark's only thread
+  auto benchmark = ::benchmark::RegisterBenchmark(caption.data(), lambda,
+                                                  BenchmarkId++, depth,
+                                                  features, models);
+  benchmark->MinTime(3.0)->UseRealTime();
+}
+
 int main(int argc, char** argv) {
   printf("Target                 Depth  Features Flags\n");
 
   int f = 10000;
-  std::vector<int> treeDepths{2, 3, 12};
+  std::vector<int> treeDepths{2, 3, 12, 16, 20};
   initializeSharedData(treeDepths, {f});
 
   addBenchmark(BMInterpreter, "Interpreter", 12, f);
   addBenchmark(BMInterpreterValueBased, "InterpreterVB", 12, f);
+
+  // compact nodes in level order vs. packed into cache-line blocks
+  for (int d = 12; d <= 20; d += 4) {
+    addBenchmark(makeBMInterpreterCompact(CompactLayout::LevelOrder),
+                 "InterpreterLevelOrder", d, f);
+    addBenchmark(makeBMInterpreterCompact(CompactLayout::Blocked, 2),
+                 "InterpreterBlockedL2", d, f);
+    addBenchmark(makeBMInterpreterCompact(CompactLayout::Blocked, 3),
+                 "InterpreterBlockedL3", d, f);
+  }
+
   addBenchmark(BMCodegenAdaptive, "AdaptiveCodegen", 12, f);
   addBenchmark(BMCodegenL1IfThenElse, "PureL1IfThenElse", 12, f);
 
@@ -44,6 +140,111 @@ int main(int argc, char** argv) {
   addBenchmark(BMCodegenL1IfThenElse, "PureL1IfThenElse", 2, f);
   addBenchmark(BMCodegenL2SubtreeSwitch, "PureL2SubtreeSwitch", 2, f);
 
+  // keep data blocks of up to 65536 rows reasonably small
+  int bf = 100;
+  initializeSharedData({12, 16}, {bf});
+  initializeSharedDataBlocks({bf}, 65536);
+
+  for (int rows : {1, 16, 256, 4096}) {
+    addBatchBenchmark(BMPerRowCalls, "PerRowCalls", 12, bf, rows);
+    addBatchBenchmark(BMBatchCall, "BatchCall", 12, bf, rows);
+    addBatchBenchmark(BMBatchCallColumnMajor, "BatchCallColumnMajor", 12, bf, rows);
+  }
+
+  // branchy single-row code vs. branch-free interleaved rows
+  addBatchBenchmark(makeBMBatchCall(makeL1IfThenElseSelector()),
+                    "BatchCallL1IfThenElse", 12, bf, 4096);
+  addBatchBenchmark(makeBMBatchCall(std::make_shared<InterleavedSelector>(4)),
+                    "BatchInterleaved4", 12, bf, 4096);
+  addBatchBenchmark(makeBMBatchCall(std::make_shared<InterleavedSelector>(8)),
+                    "BatchInterleaved8", 12, bf, 4096);
+  addBatchBenchmark(makeBMBatchCall(std::make_shared<DataParallelAVXSelector>()),
+                    "BatchDataParallelAVX", 12, bf, 4096);
+
+  // scaling across threads with a data block that doesn't fit into the cache
+  unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned threads = 1; threads < maxThreads; threads *= 2)
+    addThreadedBatchBenchmark(BMMultiThreadedBatch, "MultiThreadedBatch", 12,
+                              bf, 65536, threads);
+
+  addThreadedBatchBenchmark(BMMultiThreadedBatch, "MultiThreadedBatch", 12,
+                            bf, 65536, maxThreads);
+
+  // typical gradient-boosted ensemble size and depth
+  initializeSharedForests({6}, bf, 500);
+  addForestBenchmark(BMForestPerTreeCalls, "ForestPerTreeCalls", 6, bf, 500);
+  addForestBenchmark(BMForestSingleFunction, "ForestSingleFunction", 6, bf, 500);
+
+  // the same models in separate mappings vs. packed into pooled regions
+  addMultiModelBenchmark(makeBMMultiModel(false), "MultiModelSections", 6, bf,
+                         500);
+  addMultiModelBenchmark(makeBMMultiModel(true), "MultiModelPooled", 6, bf,
+                         500);
+
+  // restarting services: compile every time vs. load from the object cache
+  addStartupBenchmark(BMStartupColdCache, "StartupColdCache", 12, bf);
+  addStartupBenchmark(BMStartupWarmCache, "StartupWarmCache", 12, bf);
+
+  // compile time of deep trees on one thread vs. all cores
+  addStartupBenchmark(BMCompileSingleFunction, "CompileSingleFunction", 16, bf);
+  addStartupBenchmark(BMCompileParallel, "CompileParallel", 16, bf);
+  addStartupBenchmark(BMCompileLazy, "CompileLazy", 16, bf);
+
+  // compile time vs. evaluation speed of the optimization pipelines
+  addStartupBenchmark(makeBMCompileOptimized(OptimizationLevel::Fast),
+                      "CompileFast", 16, bf);
+  addStartupBenchmark(makeBMCompileOptimized(OptimizationLevel::Balanced),
+                      "CompileBalanced", 16, bf);
+  addStartupBenchmark(makeBMCompileOptimized(OptimizationLevel::Max),
+                      "CompileMax", 16, bf);
+
+  addBenchmark(makeBMEvaluateOptimized(OptimizationLevel::Fast),
+               "EvaluateFast", 12, bf);
+  addBenchmark(makeBMEvaluateOptimized(OptimizationLevel::Balanced),
+               "EvaluateBalanced", 12, bf);
+  addBenchmark(makeBMEvaluateOptimized(OptimizationLevel::Max),
+               "EvaluateMax", 12, bf);
+
+  // compile time and memory for every depth from 4 to 20, end to end and
+  // frontend only, trees of depth 12 and 16 were initialized above
+  std::vector<int> compileTimeDepths;
+  for (int depth = 4; depth <= 20; depth++)
+    if (depth != 12 && depth != 16)
+      compileTimeDepths.push_back(depth);
+
+  initializeSharedData(compileTimeDepths, {bf});
+
+  struct {
+    CompileTimeCodegen Codegen;
+    const char *EndToEndName;
+    const char *FrontendName;
+  } compileTimeCodegens[] = {
+    {CompileTimeCodegen::L1IfThenElse, "CompileL1IfThenElse",
+     "FrontendL1IfThenElse"},
+    {CompileTimeCodegen::L2SubtreeSwitch, "CompileL2SubtreeSwitch",
+     "FrontendL2SubtreeSwitch"},
+    {CompileTimeCodegen::L3SubtreeSwitchAVX, "CompileL3SubtreeSwitchAVX",
+     "FrontendL3SubtreeSwitchAVX"},
+    {CompileTimeCodegen::Adaptive, "CompileAdaptive", "FrontendAdaptive"},
+  };
+
+  for (auto &cg : compileTimeCodegens) {
+    for (int depth = 4; depth <= 20; depth++) {
+      addStartupBenchmark(makeBMCompileEndToEnd(cg.Codegen), cg.EndToEndName,
+                          depth, bf);
+      addStartupBenchmark(makeBMCompileFrontend(cg.Codegen), cg.FrontendName,
+                          depth, bf);
+    }
+  }
+
+  // many models loaded into independent JITs at service startup
+  for (unsigned threads = 1; threads < maxThreads; threads *= 2)
+    addConcurrentLoadingBenchmark(BMConcurrentLoading, "ConcurrentLoading",
+                                  12, bf, threads);
+
+  addConcurrentLoadingBenchmark(BMConcurrentLoading, "ConcurrentLoading", 12,
+                                bf, maxThreads);
+
   /*
   std::vector<int> treeDepths{6, 9, 12, 15};
   std::vector<int> dataSetFeatures {5, 10000};
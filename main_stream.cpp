@@ -0,0 +1,135 @@
+#include <getopt.h>
+#include <stdlib.h>
+
+#include <string>
+
+#include <llvm/Support/raw_ostream.h>
+
+#include "driver/StreamDriver.h"
+
+// EvalTreeJit_Stream -h
+// EvalTreeJit_Stream -f features [-c] [-r rows] [-j threads] [-o outputFile]
+//                    tree1.json [data]
+
+void printHelp(llvm::raw_ostream &out) {
+  out << "Usage: EvalTreeJit_Stream [OPTIONS] TREE [DATA]\n";
+  out << "Read decision tree file given as TREE, compile it and evaluate ";
+  out << "the rows from DATA (defaults to stdin) chunk by chunk\n";
+  out << "\n";
+  out << "OPTIONS:\n";
+  out << "  -h             Print help message\n";
+  out << "  -f FEATURES    Number of features per row (required)\n";
+  out << "  -c             Read DATA as CSV (defaults to raw 32 bit floats)\n";
+  out << "  -r ROWS        Number of rows per chunk (defaults to 65536)\n";
+  out << "  -j THREADS     Number of worker threads\n";
+  out << "  -o FILE_NAME   Write results to FILE_NAME (defaults to stdout)\n";
+  out << "\n";
+  out << "Example usage:\n";
+  out << "  EvalTreeJit_Stream -f 100 -c -o results.txt tree.json rows.csv\n";
+}
+
+void printIgnoredInput(llvm::raw_ostream &out, std::string input) {
+  out << "Ignored non-option input " << input << "\n";
+}
+
+void printIgnoredOption(llvm::raw_ostream &out, char opt) {
+  out << "Ignored option -" << opt << "\n";
+}
+
+void printIgnoredOption(llvm::raw_ostream &out, char opt, std::string arg) {
+  out << "Ignored option -" << opt << " with argument " << arg << "\n";
+}
+
+void printInvalidArgument(llvm::raw_ostream &out, std::string option,
+                          std::string arg) {
+  out << "Invalid argument for option " << option << ": " << arg << "\n";
+}
+
+bool isValidArgument(std::string arg) {
+  assert(!arg.empty());
+  return (arg.at(0) != '-');
+}
+
+bool parsePositiveInt(std::string arg, unsigned long &result) {
+  char *end;
+  result = strtoul(arg.c_str(), &end, 10);
+  return !arg.empty() && *end == '\0' && result > 0;
+}
+
+int main(int argc, char **argv) {
+  StreamDriver driver;
+
+  int c;
+  unsigned long value;
+  opterr = 0;
+  while ((c = getopt(argc, argv, "hf:cr:j:o:")) != -1) {
+    switch (c) {
+      case 'h':
+        printHelp(llvm::outs());
+        exit(EXIT_SUCCESS);
+      case 'f':
+        if (!parsePositiveInt(optarg, value)) {
+          printInvalidArgument(llvm::errs(), "-f", optarg);
+          exit(EXIT_FAILURE);
+        }
+        driver.setFeatures(value);
+        break;
+      case 'c':
+        driver.setReadCsv();
+        break;
+      case 'r':
+        if (!parsePositiveInt(optarg, value)) {
+          printInvalidArgument(llvm::errs(), "-r", optarg);
+          exit(EXIT_FAILURE);
+        }
+        driver.setRowsPerChunk(value);
+        break;
+      case 'j':
+        if (!parsePositiveInt(optarg, value)) {
+          printInvalidArgument(llvm::errs(), "-j", optarg);
+          exit(EXIT_FAILURE);
+        }
+        driver.setThreads(value);
+        break;
+      case 'o':
+        if (isValidArgument(optarg)) {
+          driver.setOutputFileName(optarg);
+          break;
+        }
+        else {
+          printInvalidArgument(llvm::errs(), "-o", optarg);
+          exit(EXIT_FAILURE);
+        }
+      case '?':
+        if (optarg)
+          printIgnoredOption(llvm::errs(), optopt, optarg);
+        else
+          printIgnoredOption(llvm::errs(), optopt);
+        break;
+      default:
+        exit(EXIT_FAILURE);
+    }
+  }
+
+  if (optind >= argc) {
+    llvm::errs() << "Missing TREE input file\n\n";
+    printHelp(llvm::errs());
+    exit(EXIT_FAILURE);
+  }
+
+  driver.setTreeFileName(argv[optind++]);
+
+  if (optind < argc)
+    driver.setDataFileName(argv[optind++]);
+
+  for (int index = optind; index < argc; index++)
+    printIgnoredInput(llvm::errs(), argv[index]);
+
+  if (!driver.isConfigurationComplete()) {
+    llvm::errs() << "Missing required argument\n\n";
+    printHelp(llvm::errs());
+    exit(EXIT_FAILURE);
+  }
+
+  return driver.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
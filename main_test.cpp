@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
 #include "test/TestDecisionTree.h"
+#include "test/TestDataSetFile.h"
+#include "test/TestDecisionTreeFile.h"
 
 #include "test/TestCGEvaluationPath.h"
 #include "test/TestCGEvaluationPathsBuilder.h"
@@ -17,6 +19,22 @@
 #include "test/TestMixedCodegenL4.h"
 #include "test/TestMixedCodegenL5.h"
 
+#include "test/TestBatchEvaluation.h"
+#include "test/TestCompactDecisionTree.h"
+#include "test/TestCompileStats.h"
+#include "test/TestForestEvaluation.h"
+#include "test/TestLazyCompilation.h"
+#include "test/TestLeafPayloads.h"
+#include "test/TestModelRegistry.h"
+#include "test/TestMultiThreadedBatchEvaluation.h"
+#include "test/TestObjectCache.h"
+#include "test/TestOptimizationLevels.h"
+#include "test/TestParallelCompilation.h"
+#include "test/TestPooledCodeMemory.h"
+#include "test/TestRowReader.h"
+#include "test/TestTieredEvaluation.h"
+#include "test/TestUnbalancedTrees.h"
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "codegen/CodeGeneratorSelector.h"
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+
+// One row per path through makePerfectDistinctGradientTree(3), so row i
+// ends in result node 7 + i.
+static std::vector<std::vector<float>>
+makeAllPathsDataSets(DataSetFactory &data) {
+  auto le = NodeEvaluation::ContinueZeroLeft;
+  auto ri = NodeEvaluation::ContinueOneRight;
+
+  return {data.makeDistinctDataSet(le, le, le),
+          data.makeDistinctDataSet(le, le, ri),
+          data.makeDistinctDataSet(le, ri, le),
+          data.makeDistinctDataSet(le, ri, ri),
+          data.makeDistinctDataSet(ri, le, le),
+          data.makeDistinctDataSet(ri, le, ri),
+          data.makeDistinctDataSet(ri, ri, le),
+          data.makeDistinctDataSet(ri, ri, ri)};
+}
+
+static std::vector<float>
+makeRowMajorBlock(const std::vector<std::vector<float>> &dataSets) {
+  std::vector<float> rows;
+  for (const std::vector<float> &ds : dataSets)
+    rows.insert(rows.end(), ds.begin(), ds.end());
+
+  return rows;
+}
+
+// transpose into one column per feature with columnStride rows each
+static std::vector<float>
+makeColumnMajorBlock(const std::vector<std::vector<float>> &dataSets,
+                     size_t columnStride) {
+  size_t features = dataSets.front().size();
+  std::vector<float> columns(features * columnStride);
+  for (size_t row = 0; row < dataSets.size(); row++)
+    for (size_t feature = 0; feature < features; feature++)
+      columns[feature * columnStride + row] = dataSets[row][feature];
+
+  return columns;
+}
+
+// the batch results match the path's result node and the single-row
+// evaluator, which keeps taking row-major input
+static void
+expectAllPathsResults(const std::vector<uint64_t> &out,
+                      JitCompileResult::Evaluator_f *fp,
+                      std::vector<std::vector<float>> &dataSets) {
+  for (uint64_t i = 0; i < dataSets.size(); i++) {
+    EXPECT_EQ(7 + i, out[i]);
+    EXPECT_EQ(fp(dataSets[i].data()), out[i]);
+  }
+}
+
+TEST(BatchEvaluation, PerfectDistinctGradientTree) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+
+  DecisionTree tree = factory.makePerfectDistinctGradientTree(3);
+  JitCompileResult result = jitDriver.run(std::move(tree));
+
+  auto *fp = result.EvaluatorFunction;
+  auto *batchFp = result.BatchEvaluatorFunction;
+  DataSetFactory data(std::move(result.Tree), 7);
+
+  auto dataSets = makeAllPathsDataSets(data);
+
+  size_t rowStride = 7;
+  std::vector<float> rows = makeRowMajorBlock(dataSets);
+
+  { // evaluate all rows at once
+    std::vector<uint64_t> out(8, 0);
+    batchFp(rows.data(), rowStride, 8, out.data());
+    expectAllPathsResults(out, fp, dataSets);
+  }
+  { // evaluate every other row
+    std::vector<uint64_t> out(4, 0);
+    batchFp(rows.data(), 2 * rowStride, 4, out.data());
+
+    EXPECT_EQ(7, out[0]);
+    EXPECT_EQ(9, out[1]);
+    EXPECT_EQ(11, out[2]);
+    EXPECT_EQ(13, out[3]);
+  }
+  { // empty batch must not write output
+    std::vector<uint64_t> out(1, 42);
+    batchFp(rows.data(), rowStride, 0, out.data());
+    EXPECT_EQ(42, out[0]);
+  }
+}
+
+TEST(BatchEvaluation, ColumnMajorLayout) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  jitDriver.setDataSetLayout(DataSetLayout::ColumnMajor);
+
+  DecisionTree tree = factory.makePerfectDistinctGradientTree(3);
+  JitCompileResult result = jitDriver.run(std::move(tree));
+
+  auto *fp = result.EvaluatorFunction;
+  auto *batchFp = result.BatchEvaluatorFunction;
+  DataSetFactory data(std::move(result.Tree), 7);
+
+  auto dataSets = makeAllPathsDataSets(data);
+
+  size_t columnStride = 8;
+  std::vector<float> columns = makeColumnMajorBlock(dataSets, columnStride);
+
+  std::vector<uint64_t> out(8, 0);
+  batchFp(columns.data(), columnStride, 8, out.data());
+  expectAllPathsResults(out, fp, dataSets);
+}
+
+TEST(BatchEvaluation, InterleavedRows) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  jitDriver.setCodegenSelector(std::make_shared<InterleavedSelector>(4));
+
+  DecisionTree tree = factory.makePerfectDistinctGradientTree(3);
+  JitCompileResult result = jitDriver.run(std::move(tree));
+
+  auto *fp = result.EvaluatorFunction;
+  auto *batchFp = result.BatchEvaluatorFunction;
+  DataSetFactory data(std::move(result.Tree), 7);
+
+  auto dataSets = makeAllPathsDataSets(data);
+
+  size_t rowStride = 7;
+  std::vector<float> rows = makeRowMajorBlock(dataSets);
+
+  { // two complete blocks of 4 rows
+    std::vector<uint64_t> out(8, 0);
+    batchFp(rows.data(), rowStride, 8, out.data());
+    expectAllPathsResults(out, fp, dataSets);
+  }
+  { // one block of 4 rows and 3 rows evaluated one by one
+    std::vector<uint64_t> out(8, 42);
+    batchFp(rows.data(), rowStride, 7, out.data());
+
+    for (uint64_t i = 0; i < 7; i++)
+      EXPECT_EQ(7 + i, out[i]);
+
+    EXPECT_EQ(42, out[7]);
+  }
+  { // no complete block
+    std::vector<uint64_t> out(2, 0);
+    batchFp(rows.data(), rowStride, 2, out.data());
+
+    EXPECT_EQ(7, out[0]);
+    EXPECT_EQ(8, out[1]);
+  }
+}
+
+TEST(BatchEvaluation, InterleavedRowsColumnMajor) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  jitDriver.setDataSetLayout(DataSetLayout::ColumnMajor);
+  jitDriver.setCodegenSelector(std::make_shared<InterleavedSelector>(4));
+
+  DecisionTree tree = factory.makePerfectDistinctGradientTree(3);
+  JitCompileResult result = jitDriver.run(std::move(tree));
+
+  auto *fp = result.EvaluatorFunction;
+  auto *batchFp = result.BatchEvaluatorFunction;
+  DataSetFactory data(std::move(result.Tree), 7);
+
+  auto dataSets = makeAllPathsDataSets(data);
+
+  size_t columnStride = 8;
+  std::vector<float> columns = makeColumnMajorBlock(dataSets, columnStride);
+
+  std::vector<uint64_t> out(8, 0);
+  batchFp(columns.data(), columnStride, 8, out.data());
+  expectAllPathsResults(out, fp, dataSets);
+}
+
+TEST(BatchEvaluation, DataParallelAVX) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  jitDriver.setCodegenSelector(std::make_shared<DataParallelAVXSelector>());
+
+  DecisionTree tree = factory.makePerfectDistinctGradientTree(3);
+  JitCompileResult result = jitDriver.run(std::move(tree));
+
+  auto *batchFp = result.BatchEvaluatorFunction;
+  DataSetFactory data(std::move(result.Tree), 7);
+
+  // 8 rows in reverse order fill one vector, 3 more rows are left over
+  auto paths = makeAllPathsDataSets(data);
+  std::vector<std::vector<float>> dataSets(paths.rbegin(), paths.rend());
+  dataSets.push_back(paths[2]);
+  dataSets.push_back(paths[5]);
+  dataSets.push_back(paths[0]);
+
+  std::vector<uint64_t> expected {14, 13, 12, 11, 10, 9, 8, 7, 9, 12, 7};
+
+  size_t rowStride = 7;
+  std::vector<float> rows = makeRowMajorBlock(dataSets);
+
+  std::vector<uint64_t> out(11, 0);
+  batchFp(rows.data(), rowStride, 11, out.data());
+
+  for (uint64_t i = 0; i < 11; i++)
+    EXPECT_EQ(expected[i], out[i]);
+}
+
+TEST(BatchEvaluation, DataParallelAVXColumnMajor) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  jitDriver.setDataSetLayout(DataSetLayout::ColumnMajor);
+  jitDriver.setCodegenSelector(std::make_shared<DataParallelAVXSelector>());
+
+  DecisionTree tree = factory.makePerfectDistinctGradientTree(3);
+  JitCompileResult result = jitDriver.run(std::move(tree));
+
+  auto *batchFp = result.BatchEvaluatorFunction;
+  DataSetFactory data(std::move(result.Tree), 7);
+
+  auto paths = makeAllPathsDataSets(data);
+  std::vector<std::vector<float>> dataSets(paths.rbegin(), paths.rend());
+
+  size_t columnStride = 8;
+  std::vector<float> columns = makeColumnMajorBlock(dataSets, columnStride);
+
+  std::vector<uint64_t> out(8, 0);
+  batchFp(columns.data(), columnStride, 8, out.data());
+
+  for (uint64_t i = 0; i < 8; i++)
+    EXPECT_EQ(14 - i, out[i]);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "data/CompactDecisionTree.h"
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/utility/Interpreter.h"
+
+TEST(CompactDecisionTree, SameResultsAsInterpreter) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(10, 100);
+  CompactDecisionTree compactTree(tree);
+
+  // perfect trees keep their level-order layout
+  EXPECT_EQ(tree.getNodeIdxBound(), compactTree.getNumNodes());
+  EXPECT_EQ(1u, compactTree.getNodes()[0].FirstChildIdx);
+
+  Interpreter interpreter;
+  DataSetFactory data(tree.copy(), 100);
+
+  for (auto &dataSet : data.makeRandomDataSets(200))
+    EXPECT_EQ(interpreter.run(tree, dataSet.data()),
+              interpreter.run(compactTree, dataSet.data()));
+}
+
+TEST(CompactDecisionTree, NonAdjacentChildren) {
+  // tree with swapped children on the first level:
+  //        0
+  //    2       1
+  //  5   6   3   4
+  DecisionTree tree(2, 3);
+  tree.addNodes(DecisionTreeNode(0, 0.5f, 0, 2, 1),
+                DecisionTreeNode(1, 0.5f, 1, 3, 4),
+                DecisionTreeNode(2, 0.5f, 2, 5, 6));
+  tree.finalize();
+
+  CompactDecisionTree compactTree(tree);
+  ASSERT_EQ(7u, compactTree.getNumNodes());
+
+  Interpreter interpreter;
+  for (float f0 : {0.0f, 1.0f}) {
+    for (float f1 : {0.0f, 1.0f}) {
+      for (float f2 : {0.0f, 1.0f}) {
+        std::vector<float> dataSet{f0, f1, f2};
+        EXPECT_EQ(interpreter.run(tree, dataSet.data()),
+                  interpreter.run(compactTree, dataSet.data()));
+      }
+    }
+  }
+}
+
+TEST(CompactDecisionTree, BlockedLayout) {
+  DecisionTreeFactory factory;
+  Interpreter interpreter;
+
+  // depths that do and don't fill the last level of blocks
+  for (uint8_t depth : {6, 7, 11}) {
+    DecisionTree tree = factory.makePerfectRandomTree(depth, 100);
+    DataSetFactory data(tree.copy(), 100);
+    auto dataSets = data.makeRandomDataSets(100);
+
+    for (uint8_t blockLevels : {1, 2, 3, 4}) {
+      CompactDecisionTree compactTree(tree, CompactLayout::Blocked,
+                                      blockLevels);
+
+      const CompactDecisionTree::Node *nodes = compactTree.getNodes();
+      EXPECT_EQ(0u, (uintptr_t)nodes % CompactDecisionTree::CacheLineSize);
+
+      // the root's children share its block
+      EXPECT_EQ(blockLevels > 1 ? 1u : 2u, nodes[0].FirstChildIdx);
+
+      for (auto &dataSet : dataSets)
+        EXPECT_EQ(interpreter.run(tree, dataSet.data()),
+                  interpreter.run(compactTree, dataSet.data()));
+    }
+  }
+}
+
+TEST(CompactDecisionTree, BlockedLayoutPacksResults) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(6, 100);
+  CompactDecisionTree compactTree(tree, CompactLayout::Blocked, 3);
+
+  // one block for levels 0-2 and 8 blocks for levels 3-5, the 64 results
+  // fill 8 more blocks instead of one block each
+  EXPECT_EQ(17u * 8u, compactTree.getNumNodes());
+
+  Interpreter interpreter;
+  DataSetFactory data(tree.copy(), 100);
+
+  for (auto &dataSet : data.makeRandomDataSets(100))
+    EXPECT_EQ(interpreter.run(tree, dataSet.data()),
+              interpreter.run(compactTree, dataSet.data()));
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include "compiler/CompileStats.h"
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+
+TEST(CompileStats, AllPhasesRecorded) {
+  using std::chrono::nanoseconds;
+
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  JitCompileResult result =
+      jitDriver.run(factory.makePerfectRandomTree(6, 20));
+  const CompileStats &stats = result.Stats;
+
+  EXPECT_GT(stats.IREmission, nanoseconds(0));
+  EXPECT_GT(stats.PathBuilding, nanoseconds(0));
+  EXPECT_GT(stats.VariationBuilding, nanoseconds(0));
+  EXPECT_GT(stats.Optimization, nanoseconds(0));
+  EXPECT_GT(stats.MachineCodeEmission, nanoseconds(0));
+  EXPECT_GT(stats.Linking, nanoseconds(0));
+
+  // levels 6 to 4 with if-then-else, a leaf switch for the last 3 levels
+  ASSERT_EQ(1u, stats.CodegenEmission.count("L1IfThenElse"));
+  ASSERT_EQ(1u, stats.CodegenEmission.count("L3SubtreeSwitchAVX"));
+  EXPECT_LE(stats.CodegenEmission.at("L3SubtreeSwitchAVX"), stats.IREmission);
+  EXPECT_LE(stats.PathBuilding + stats.VariationBuilding,
+            stats.CodegenEmission.at("L3SubtreeSwitchAVX"));
+
+  EXPECT_GT(stats.IRInstructions, 0u);
+  EXPECT_GT(stats.OptimizedIRInstructions, 0u);
+  EXPECT_GT(stats.ObjectFileBytes, 0u);
+}
+
+TEST(CompileStats, ParallelCompileSumsUpModules) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(8, 20);
+
+  JitDriver singleJit;
+  CompileStats single = singleJit.run(tree.copy()).Stats;
+
+  JitDriver parallelJit;
+  parallelJit.setParallelCompile(2, 4);
+  CompileStats parallel = parallelJit.run(tree.copy()).Stats;
+
+  // the subtree modules add calls and function frames
+  EXPECT_GE(parallel.IRInstructions, single.IRInstructions);
+  EXPECT_GT(parallel.ObjectFileBytes, 0u);
+  EXPECT_GT(parallel.Optimization, std::chrono::nanoseconds(0));
+  EXPECT_GT(parallel.MachineCodeEmission, std::chrono::nanoseconds(0));
+}
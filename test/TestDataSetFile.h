@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "data/DataSetFile.h"
+
+TEST(DataSetFile, WriteAndMap) {
+  llvm::SmallString<256> fileName;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("TestDataSetFile", "data",
+                                                  fileName));
+
+  // 3 rows of 5 features with input stride 6
+  std::vector<float> rows;
+  for (int i = 0; i < 18; i++)
+    rows.push_back(i);
+
+  ASSERT_FALSE(writeDataSetFile(fileName.str(), rows.data(), 3, 5, 6));
+
+  auto mapped = MappedDataSet::open(fileName.str());
+  llvm::sys::fs::remove(fileName);
+  ASSERT_TRUE((bool)mapped);
+
+  const MappedDataSet &dataSet = **mapped;
+  EXPECT_EQ(5, dataSet.getNumFeatures());
+  EXPECT_EQ(3, dataSet.getNumRows());
+  EXPECT_EQ(8, dataSet.getRowStride());
+
+  for (uint64_t row = 0; row < 3; row++) {
+    float *rowPtr = dataSet.getRow(row);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(rowPtr) % 32);
+
+    for (uint64_t feature = 0; feature < 5; feature++)
+      EXPECT_EQ(rows[row * 6 + feature], rowPtr[feature]);
+
+    // padding
+    EXPECT_EQ(0.0f, rowPtr[5]);
+    EXPECT_EQ(0.0f, rowPtr[7]);
+  }
+}
+
+TEST(DataSetFile, RejectInvalidFile) {
+  llvm::SmallString<256> fileName;
+  int FD;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("TestDataSetFile", "data",
+                                                  FD, fileName));
+  {
+    llvm::raw_fd_ostream out(FD, true);
+    out << "no data-set file, but long enough for a header. "
+           "no data-set file, but long enough for a header.";
+  }
+
+  auto mapped = MappedDataSet::open(fileName.str());
+  llvm::sys::fs::remove(fileName);
+
+  EXPECT_FALSE((bool)mapped);
+  EXPECT_EQ(std::errc::invalid_argument, mapped.getError());
+}
+
+TEST(DataSetFile, RejectOverflowingRowCount) {
+  llvm::SmallString<256> fileName;
+  int FD;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("TestDataSetFile", "data",
+                                                  FD, fileName));
+
+  // Rows * RowStride * sizeof(float) wraps around to 0
+  DataSetFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.Magic, DataSetFileHeader::ExpectedMagic, 8);
+  header.Version = DataSetFileHeader::CurrentVersion;
+  header.Features = 8;
+  header.Rows = uint64_t(1) << 59;
+  header.RowStride = 8;
+  header.DataOffset = sizeof(DataSetFileHeader);
+  {
+    std::vector<float> row(8, 1.0f);
+    llvm::raw_fd_ostream out(FD, true);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(row.data()),
+              row.size() * sizeof(float));
+  }
+
+  auto mapped = MappedDataSet::open(fileName.str());
+  llvm::sys::fs::remove(fileName);
+
+  EXPECT_FALSE((bool)mapped);
+  EXPECT_EQ(std::errc::invalid_argument, mapped.getError());
+}
@@ -26,6 +26,70 @@ TEST(DecisionTreeFactory, getFirstNodeIdxOnLevel) {
   }
 }
 
+TEST(DecisionTree, DenseNodeStorage) {
+  DecisionTreeFactory treeFactory;
+  DecisionTree tree = treeFactory.makePerfectRandomTree(4, 10);
+
+  // 15 regular nodes followed by 16 implicit result nodes
+  ASSERT_EQ(31u, tree.getNodeIdxBound());
+  EXPECT_FALSE(tree.hasNode(31));
+
+  for (uint64_t idx = 0; idx < 31; idx++) {
+    ASSERT_TRUE(tree.hasNode(idx));
+    EXPECT_EQ(idx, tree.getNodePtr(idx)->getIdx());
+    EXPECT_EQ(idx >= 15, tree.getNode(idx).isImplicit());
+
+    if (idx > 0)
+      EXPECT_EQ(tree.getNodePtr(idx - 1) + 1, tree.getNodePtr(idx));
+  }
+
+  // copies have their own storage
+  DecisionTree copy = tree.copy();
+  EXPECT_NE(tree.getNodePtr(0), copy.getNodePtr(0));
+  EXPECT_EQ(tree.getNode(7), copy.getNode(7));
+}
+
+TEST(DecisionTree, SparseNodeStorage) {
+  // only the leftmost path continues, the right children are results:
+  //        0
+  //      1   r
+  //    3   r
+  //   ...
+  uint8_t levels = 60;
+  DecisionTree tree(levels, levels);
+  for (uint8_t level = 0; level < levels; level++) {
+    uint64_t idx = DecisionTree::getFirstNodeIdxOnLevel(level);
+    tree.addNode(DecisionTreeNode(idx, 0.5f, 0, 2 * idx + 1, 2 * idx + 2));
+  }
+  tree.finalize();
+
+  // slots for 60 regular nodes and 61 result nodes instead of one per index
+  EXPECT_EQ(PowerOf2(60) + 1, tree.getNodeIdxBound());
+  EXPECT_FALSE(tree.usesNodeIdxAsSlot());
+  ASSERT_EQ(121u, tree.getNumNodeSlots());
+
+  uint64_t lastIdx = DecisionTree::getFirstNodeIdxOnLevel(levels);
+  EXPECT_TRUE(tree.getNode(lastIdx).isImplicit());
+  EXPECT_TRUE(tree.getNode(lastIdx + 1).isImplicit());
+  EXPECT_FALSE(tree.getNode(lastIdx / 2).isImplicit());
+  EXPECT_FALSE(tree.hasNode(5));
+  EXPECT_FALSE(tree.hasNode(lastIdx + 2));
+
+  // slots are in index order
+  for (uint64_t slot = 1; slot < tree.getNumNodeSlots(); slot++)
+    EXPECT_LT(tree.getNodeInSlot(slot - 1).getIdx(),
+              tree.getNodeInSlot(slot).getIdx());
+
+  for (uint64_t slot = 0; slot < tree.getNumNodeSlots(); slot++) {
+    uint64_t idx = tree.getNodeInSlot(slot).getIdx();
+    EXPECT_EQ(slot, tree.getNodeSlot(idx));
+    EXPECT_EQ(idx, tree.getNodePtr(idx)->getIdx());
+  }
+
+  DecisionTree copy = tree.copy();
+  EXPECT_EQ(tree.getNode(lastIdx), copy.getNode(lastIdx));
+}
+
 TEST(DecisionSubtreeRef, collectNodes) {
   DecisionTreeFactory treeFactory;
   DecisionTree tree = treeFactory.makePerfectDistinctUniformTree(4);
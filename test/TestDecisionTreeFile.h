@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <system_error>
+
+#include <gtest/gtest.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "data/DecisionTree.h"
+#include "data/DecisionTreeFile.h"
+
+static llvm::ErrorOr<DecisionTree> readDecisionTreeJson(std::string content) {
+  llvm::SmallString<256> fileName;
+  int FD;
+  if (std::error_code EC = llvm::sys::fs::createTemporaryFile(
+          "TestDecisionTreeFile", "json", FD, fileName))
+    return EC;
+
+  {
+    llvm::raw_fd_ostream out(FD, true);
+    out << content;
+  }
+
+  llvm::ErrorOr<DecisionTree> tree = readDecisionTreeFile(fileName.str());
+  llvm::sys::fs::remove(fileName);
+  return tree;
+}
+
+TEST(DecisionTreeFile, Read) {
+  // node 3 has a single child, 2, 4 and 7 are result nodes
+  auto tree = readDecisionTreeJson(R"({ "nodes": [
+      { "id": 3, "feature": 2, "bias": 0.5, "left": 7 },
+      { "id": 0, "feature": 0, "bias": 0.5, "left": 1, "right": 2 },
+      { "id": 1, "feature": 1, "bias": 0.25, "left": 3, "right": 4 }
+  ] })");
+
+  ASSERT_TRUE((bool)tree);
+  EXPECT_EQ(3, tree->getNumLevels());
+  EXPECT_EQ(8u, tree->getNodeIdxBound());
+
+  DecisionTreeNode node = tree->getNode(1);
+  EXPECT_EQ(1u, node.getFeatureIdx());
+  EXPECT_EQ(0.25f, node.getFeatureBias());
+  EXPECT_EQ(3u, node.getLeftChildIdx());
+  EXPECT_EQ(4u, node.getRightChildIdx());
+
+  EXPECT_TRUE(tree->getNode(3).hasSingleChild());
+  for (uint64_t idx : {2, 4, 7})
+    EXPECT_TRUE(tree->getNode(idx).isImplicit());
+}
+
+TEST(DecisionTreeFile, RejectInvalidFile) {
+  auto expectInvalid = [](std::string content) {
+    auto tree = readDecisionTreeJson(std::move(content));
+    EXPECT_FALSE((bool)tree);
+    EXPECT_EQ(std::errc::invalid_argument, tree.getError());
+  };
+
+  // no JSON
+  expectInvalid("no decision tree");
+
+  // no nodes
+  expectInvalid(R"({ "nodes": [] })");
+
+  // no root
+  expectInvalid(R"({ "nodes": [
+      { "id": 1, "feature": 0, "bias": 0.5, "left": 3, "right": 4 }
+  ] })");
+
+  // child not at its level-order position
+  expectInvalid(R"({ "nodes": [
+      { "id": 0, "feature": 0, "bias": 0.5, "left": 2, "right": 1 }
+  ] })");
+
+  // no children
+  expectInvalid(R"({ "nodes": [
+      { "id": 0, "feature": 0, "bias": 0.5 }
+  ] })");
+
+  // duplicate node
+  expectInvalid(R"({ "nodes": [
+      { "id": 0, "feature": 0, "bias": 0.5, "left": 1, "right": 2 },
+      { "id": 0, "feature": 1, "bias": 0.5, "left": 1, "right": 2 }
+  ] })");
+
+  // node not reachable from the root
+  expectInvalid(R"({ "nodes": [
+      { "id": 0, "feature": 0, "bias": 0.5, "left": 1 },
+      { "id": 2, "feature": 0, "bias": 0.5, "left": 5, "right": 6 }
+  ] })");
+
+  // missing feature
+  expectInvalid(R"({ "nodes": [
+      { "id": 0, "bias": 0.5, "left": 1, "right": 2 }
+  ] })");
+}
+
+TEST(DecisionTreeFile, MissingFile) {
+  auto tree = readDecisionTreeFile("/nonexistent/tree.json");
+  EXPECT_FALSE((bool)tree);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+
+TEST(ForestEvaluation, SumOfDistinctGradientTrees) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  jitDriver.setTreesPerFunction(2);
+
+  std::vector<DecisionTree> trees;
+  for (int i = 0; i < 5; i++)
+    trees.push_back(factory.makePerfectDistinctGradientTree(3));
+
+  JitForestCompileResult result = jitDriver.run(std::move(trees));
+  ASSERT_EQ(5, result.Trees.size());
+
+  auto *fp = result.EvaluatorFunction;
+  DataSetFactory data(std::move(result.Trees[0]), 7);
+
+  auto le = NodeEvaluation::ContinueZeroLeft;
+  auto ri = NodeEvaluation::ContinueOneRight;
+
+  // all trees reach the same result node
+  EXPECT_EQ(5 * 7, fp(data.makeDistinctDataSet(le, le, le).data()));
+  EXPECT_EQ(5 * 10, fp(data.makeDistinctDataSet(le, ri, ri).data()));
+  EXPECT_EQ(5 * 11, fp(data.makeDistinctDataSet(ri, le, le).data()));
+  EXPECT_EQ(5 * 14, fp(data.makeDistinctDataSet(ri, ri, ri).data()));
+}
+
+TEST(ForestEvaluation, SumOfRandomTrees) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  jitDriver.setTreesPerFunction(3);
+
+  std::vector<DecisionTree> trees;
+  trees.push_back(factory.makePerfectRandomTree(4, 20));
+  trees.push_back(factory.makePerfectRandomTree(2, 20));
+  trees.push_back(factory.makePerfectRandomTree(6, 20));
+  trees.push_back(factory.makePerfectRandomTree(5, 20));
+
+  // compile each tree on its own for reference
+  std::vector<JitCompileResult::Evaluator_f *> treeFps;
+  for (const DecisionTree &tree : trees)
+    treeFps.push_back(jitDriver.run(tree.copy()).EvaluatorFunction);
+
+  JitForestCompileResult result = jitDriver.run(std::move(trees));
+  auto *forestFp = result.EvaluatorFunction;
+
+  DataSetFactory data(std::move(result.Trees[0]), 20);
+  for (std::vector<float> &dataSet : data.makeRandomDataSets(10)) {
+    uint64_t expected = 0;
+    for (JitCompileResult::Evaluator_f *fp : treeFps)
+      expected += fp(dataSet.data());
+
+    EXPECT_EQ(expected, forestFp(dataSet.data()));
+  }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+#include "driver/utility/Interpreter.h"
+
+TEST(LazyCompilation, SameResultsAsInterpreter) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(10, 20);
+
+  Interpreter interpreter;
+  DataSetFactory data(tree.copy(), 20);
+  auto dataSets = data.makeRandomDataSets(200);
+
+  std::vector<uint64_t> expected;
+  for (auto &dataSet : dataSets)
+    expected.push_back(interpreter.run(tree, dataSet.data()));
+
+  for (uint8_t splitLevel : {1, 4, 7}) {
+    JitDriver jitDriver;
+    jitDriver.setLazyCompile(splitLevel);
+    JitCompileResult result = jitDriver.run(tree.copy());
+
+    // the second round runs through the patched stubs
+    for (int round = 0; round < 2; round++) {
+      std::vector<uint64_t> out(dataSets.size());
+      for (size_t i = 0; i < dataSets.size(); i++) {
+        EXPECT_EQ(expected[i], result.EvaluatorFunction(dataSets[i].data()));
+        result.BatchEvaluatorFunction(dataSets[i].data(), 20, 1, &out[i]);
+      }
+
+      EXPECT_EQ(expected, out);
+    }
+  }
+}
+
+TEST(LazyCompilation, StartupCompilesTopLevelsOnly) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(12, 20);
+
+  JitDriver eagerJit;
+  JitCompileResult eager = eagerJit.run(tree.copy());
+
+  JitDriver lazyJit;
+  lazyJit.setLazyCompile(4);
+  JitCompileResult lazy = lazyJit.run(tree.copy());
+
+  EXPECT_LT(lazy.Stats.ObjectFileBytes, eager.Stats.ObjectFileBytes);
+}
+
+TEST(LazyCompilation, UnloadWithPendingSubtrees) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(8, 20);
+
+  Interpreter interpreter;
+  DataSetFactory data(tree.copy(), 20);
+  std::vector<float> dataSet = data.makeRandomDataSets(1).front();
+
+  JitDriver jitDriver;
+  jitDriver.setLazyCompile(3);
+
+  // compile a single subtree of the first tree and unload it with the rest
+  // still pending
+  JitCompileResult first = jitDriver.run(tree.copy());
+  EXPECT_EQ(interpreter.run(tree, dataSet.data()),
+            first.EvaluatorFunction(dataSet.data()));
+  jitDriver.unload(first.ModuleHandle);
+
+  JitCompileResult second = jitDriver.run(tree.copy());
+  EXPECT_EQ(interpreter.run(tree, dataSet.data()),
+            second.EvaluatorFunction(dataSet.data()));
+}
+
+TEST(LazyCompilation, ConcurrentFirstCalls) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(10, 20);
+
+  Interpreter interpreter;
+  DataSetFactory data(tree.copy(), 20);
+  auto dataSets = data.makeRandomDataSets(200);
+
+  std::vector<uint64_t> expected;
+  for (auto &dataSet : dataSets)
+    expected.push_back(interpreter.run(tree, dataSet.data()));
+
+  JitDriver jitDriver;
+  jitDriver.setLazyCompile(2);
+  JitCompileResult result = jitDriver.run(tree.copy());
+  auto *fp = result.EvaluatorFunction;
+
+  // all threads evaluate the same rows, so they race into the same stubs
+  std::vector<std::vector<uint64_t>> out(4);
+  std::vector<std::thread> threads;
+  for (std::vector<uint64_t> &threadOut : out)
+    threads.emplace_back([&dataSets, &threadOut, fp]() {
+      for (auto &dataSet : dataSets)
+        threadOut.push_back(fp(dataSet.data()));
+    });
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  for (const std::vector<uint64_t> &threadOut : out)
+    EXPECT_EQ(expected, threadOut);
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "codegen/CodeGeneratorSelector.h"
+#include "codegen/L1IfThenElse.h"
+#include "codegen/LXSubtreeSwitch.h"
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+
+DecisionTree makeTrivialGradientScoreTree(DecisionTreeFactory &factory) {
+  DecisionTree tree = factory.makePerfectTrivialGradientTree(3);
+  for (uint64_t i = 0; i < 8; i++)
+    tree.setLeafScore(7 + i, 0.5f * i);
+
+  return tree;
+}
+
+TEST(LeafPayloads, ScoresL1IfThenElse) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+
+  jitDriver.setCodegenSelector(makeLambdaSelector(
+      [](const CompilerSession &session, int remainingLevels) {
+        static L1IfThenElse codegen;
+        return &codegen;
+      }));
+
+  JitCompileResult result =
+      jitDriver.run(makeTrivialGradientScoreTree(factory));
+
+  EXPECT_EQ(nullptr, result.EvaluatorFunction);
+  auto *fp = result.ScoreEvaluatorFunction;
+
+  DataSetFactory data;
+  for (uint64_t i = 0; i < 8; i++) {
+    float value = (2 * i + 1) / 16.0f;
+    EXPECT_EQ(0.5f * i, fp(data.makeTrivialDataSet(value).data()));
+  }
+}
+
+TEST(LeafPayloads, ScoresLXSubtreeSwitch) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+
+  // switch tables hold the payloads
+  jitDriver.setCodegenSelector(makeLambdaSelector(
+      [](const CompilerSession &session, int remainingLevels) {
+        static LXSubtreeSwitch codegen(3);
+        return &codegen;
+      }));
+
+  JitCompileResult result =
+      jitDriver.run(makeTrivialGradientScoreTree(factory));
+
+  auto *fp = result.ScoreEvaluatorFunction;
+  auto *batchFp = result.ScoreBatchEvaluatorFunction;
+
+  std::vector<float> rows;
+  DataSetFactory data;
+  for (uint64_t i = 0; i < 8; i++) {
+    float value = (2 * i + 1) / 16.0f;
+    EXPECT_EQ(0.5f * i, fp(data.makeTrivialDataSet(value).data()));
+    rows.push_back(value);
+  }
+
+  std::vector<float> out(8, -1.0f);
+  batchFp(rows.data(), 1, 8, out.data());
+
+  for (uint64_t i = 0; i < 8; i++)
+    EXPECT_EQ(0.5f * i, out[i]);
+}
+
+TEST(LeafPayloads, ClassIdsInterleaved) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  jitDriver.setCodegenSelector(std::make_shared<InterleavedSelector>(4));
+
+  DecisionTree tree = factory.makePerfectTrivialGradientTree(3);
+  for (uint64_t i = 0; i < 8; i++)
+    tree.setLeafClassId(7 + i, i % 3);
+
+  JitCompileResult result = jitDriver.run(std::move(tree));
+  EXPECT_EQ(3, result.Tree->getNumClasses());
+
+  auto *fp = result.EvaluatorFunction;
+  auto *batchFp = result.BatchEvaluatorFunction;
+
+  std::vector<float> rows;
+  DataSetFactory data;
+  for (uint64_t i = 0; i < 8; i++) {
+    float value = (2 * i + 1) / 16.0f;
+    EXPECT_EQ(i % 3, fp(data.makeTrivialDataSet(value).data()));
+    rows.push_back(value);
+  }
+
+  std::vector<uint64_t> out(8, 42);
+  batchFp(rows.data(), 1, 8, out.data());
+
+  for (uint64_t i = 0; i < 8; i++)
+    EXPECT_EQ(i % 3, out[i]);
+}
+
+TEST(LeafPayloads, ForestScoreSum) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  jitDriver.setTreesPerFunction(2);
+
+  std::vector<DecisionTree> trees;
+  for (int i = 0; i < 3; i++)
+    trees.push_back(makeTrivialGradientScoreTree(factory));
+
+  JitForestCompileResult result = jitDriver.run(std::move(trees));
+  auto *fp = result.ScoreEvaluatorFunction;
+
+  DataSetFactory data;
+  for (uint64_t i = 0; i < 8; i++) {
+    float value = (2 * i + 1) / 16.0f;
+    EXPECT_EQ(3 * 0.5f * i, fp(data.makeTrivialDataSet(value).data()));
+  }
+}
+
+TEST(LeafPayloads, ForestClassVote) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  jitDriver.setTreesPerFunction(2);
+
+  // left half of the result nodes votes for the tree's first class, right
+  // half for its second class
+  auto makeVotingTree = [&factory](uint64_t leftClass, uint64_t rightClass) {
+    DecisionTree tree = factory.makePerfectTrivialGradientTree(3);
+    for (uint64_t i = 0; i < 8; i++)
+      tree.setLeafClassId(7 + i, i < 4 ? leftClass : rightClass);
+
+    return tree;
+  };
+
+  std::vector<DecisionTree> trees;
+  trees.push_back(makeVotingTree(0, 2));
+  trees.push_back(makeVotingTree(1, 2));
+  trees.push_back(makeVotingTree(1, 0));
+
+  JitForestCompileResult result = jitDriver.run(std::move(trees));
+  auto *fp = result.EvaluatorFunction;
+
+  DataSetFactory data;
+  EXPECT_EQ(1, fp(data.makeTrivialDataSet(1.0f / 16).data()));
+  EXPECT_EQ(2, fp(data.makeTrivialDataSet(15.0f / 16).data()));
+}
+
+TEST(LeafPayloads, MissingPayload) {
+  DecisionTreeFactory factory;
+
+  DecisionTree nodeIdxTree = factory.makePerfectTrivialGradientTree(3);
+  EXPECT_EQ(DecisionTreeNode::NoNodeIdx,
+            nodeIdxTree.findResultWithoutPayload());
+
+  DecisionTree scoreTree = makeTrivialGradientScoreTree(factory);
+  EXPECT_EQ(DecisionTreeNode::NoNodeIdx,
+            scoreTree.findResultWithoutPayload());
+
+  DecisionTree partialTree = factory.makePerfectTrivialGradientTree(3);
+  for (uint64_t i = 0; i < 8; i++)
+    if (i != 5)
+      partialTree.setLeafClassId(7 + i, i % 3);
+
+  EXPECT_EQ(12u, partialTree.findResultWithoutPayload());
+}
+
+TEST(LeafPayloads, RejectInvalidPayloads) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+
+  DecisionTree partialTree = factory.makePerfectTrivialGradientTree(3);
+  for (uint64_t i = 0; i < 7; i++)
+    partialTree.setLeafClassId(7 + i, i % 3);
+
+  JitCompileResult result = jitDriver.run(partialTree.copy());
+  EXPECT_FALSE(result.Success);
+  EXPECT_FALSE(result.ErrorMessage.empty());
+  EXPECT_EQ(nullptr, result.EvaluatorFunction);
+  EXPECT_EQ(nullptr, result.BatchEvaluatorFunction);
+
+  { // forest with a tree that misses a payload
+    std::vector<DecisionTree> trees;
+    trees.push_back(makeTrivialGradientScoreTree(factory));
+    trees.push_back(factory.makePerfectTrivialGradientTree(3));
+    for (uint64_t i = 1; i < 8; i++)
+      trees.back().setLeafScore(7 + i, 0.5f);
+
+    JitForestCompileResult forest = jitDriver.run(std::move(trees));
+    EXPECT_FALSE(forest.Success);
+    EXPECT_EQ(nullptr, forest.ScoreEvaluatorFunction);
+  }
+  { // forest with mixed payload kinds
+    std::vector<DecisionTree> trees;
+    trees.push_back(makeTrivialGradientScoreTree(factory));
+    trees.push_back(factory.makePerfectTrivialGradientTree(3));
+
+    JitForestCompileResult forest = jitDriver.run(std::move(trees));
+    EXPECT_FALSE(forest.Success);
+    EXPECT_EQ(nullptr, forest.EvaluatorFunction);
+    EXPECT_EQ(nullptr, forest.ScoreEvaluatorFunction);
+  }
+
+  // the driver keeps working after rejecting trees
+  JitCompileResult valid =
+      jitDriver.run(makeTrivialGradientScoreTree(factory));
+  EXPECT_TRUE(valid.Success);
+  EXPECT_NE(nullptr, valid.ScoreEvaluatorFunction);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/ModelRegistry.h"
+#include "driver/utility/Interpreter.h"
+
+TEST(ModelRegistry, ReplaceKeepsOldModelAliveForHolders) {
+  DecisionTreeFactory factory;
+  DecisionTree tree1 = factory.makePerfectRandomTree(6, 20);
+  DecisionTree tree2 = factory.makePerfectRandomTree(6, 20);
+
+  DataSetFactory data(tree1.copy(), 20);
+  auto dataSets = data.makeRandomDataSets(50);
+
+  ModelRegistry registry;
+  EXPECT_EQ(nullptr, registry.get("model"));
+
+  registry.replace("model", tree1.copy());
+  ModelRegistry::Model_t oldModel = registry.get("model");
+  ASSERT_NE(nullptr, oldModel);
+
+  registry.replace("model", tree2.copy());
+  ModelRegistry::Model_t newModel = registry.get("model");
+  ASSERT_NE(oldModel, newModel);
+
+  Interpreter interpreter;
+  auto *oldFp = oldModel->getCompileResult().EvaluatorFunction;
+  auto *newFp = newModel->getCompileResult().EvaluatorFunction;
+
+  for (auto &dataSet : dataSets) {
+    EXPECT_EQ(interpreter.run(tree1, dataSet.data()), oldFp(dataSet.data()));
+    EXPECT_EQ(interpreter.run(tree2, dataSet.data()), newFp(dataSet.data()));
+  }
+
+  oldModel.reset(); // unloads tree1's module
+  EXPECT_TRUE(registry.remove("model"));
+  EXPECT_FALSE(registry.remove("model"));
+  EXPECT_EQ(nullptr, registry.get("model"));
+
+  // removed from the registry, but still loaded for this holder
+  for (auto &dataSet : dataSets)
+    EXPECT_EQ(interpreter.run(tree2, dataSet.data()), newFp(dataSet.data()));
+}
+
+TEST(ModelRegistry, ConcurrentReadersDuringReplace) {
+  DecisionTreeFactory factory;
+  std::vector<DecisionTree> trees;
+  for (int i = 0; i < 2; i++)
+    trees.push_back(factory.makePerfectRandomTree(8, 20));
+
+  std::vector<float> dataSet(20, 0.5f);
+  Interpreter interpreter;
+  uint64_t expected[] = {interpreter.run(trees[0], dataSet.data()),
+                         interpreter.run(trees[1], dataSet.data())};
+
+  ModelRegistry registry;
+  registry.replace("model", trees[0].copy());
+
+  std::atomic<bool> done(false);
+  std::atomic<uint64_t> wrongResults(0);
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&]() {
+      while (!done) {
+        ModelRegistry::Model_t model = registry.get("model");
+        uint64_t result =
+            model->getCompileResult().EvaluatorFunction(dataSet.data());
+
+        if (result != expected[0] && result != expected[1])
+          wrongResults++;
+      }
+    });
+  }
+
+  for (int i = 0; i < 20; i++)
+    registry.replace("model", trees[i % 2].copy());
+
+  done = true;
+  for (std::thread &reader : readers)
+    reader.join();
+
+  EXPECT_EQ(0, wrongResults.load());
+}
+
+TEST(ModelRegistry, ReplaceReleasesCompilerContext) {
+  DecisionTreeFactory factory;
+  ModelRegistry registry;
+
+  registry.replace("model", factory.makePerfectRandomTree(6, 20));
+  std::weak_ptr<JitDriver> firstJit =
+      registry.get("model")->getJitDriver();
+
+  // each replacement compiles in a fresh driver and context, the one of a
+  // replaced model is released with the model
+  std::vector<std::weak_ptr<JitDriver>> replacedJits;
+  for (int i = 0; i < 10; i++) {
+    registry.replace("model", factory.makePerfectRandomTree(6, 20));
+    ModelRegistry::Model_t model = registry.get("model");
+    replacedJits.push_back(model->getJitDriver());
+  }
+
+  EXPECT_TRUE(firstJit.expired());
+  for (int i = 0; i < 9; i++)
+    EXPECT_TRUE(replacedJits[i].expired());
+
+  EXPECT_FALSE(replacedJits.back().expired());
+}
+
+TEST(ModelRegistry, RejectedReplaceKeepsModel) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectTrivialGradientTree(3);
+
+  DecisionTree partialTree = factory.makePerfectTrivialGradientTree(3);
+  partialTree.setLeafClassId(7, 1);
+
+  ModelRegistry registry;
+  ModelRegistry::Model_t model = registry.replace("model", tree.copy());
+  ASSERT_NE(nullptr, model);
+  EXPECT_TRUE(model->getCompileResult().Success);
+
+  EXPECT_EQ(nullptr, registry.replace("model", std::move(partialTree)));
+  EXPECT_EQ(model, registry.get("model"));
+}
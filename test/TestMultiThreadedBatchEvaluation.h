@@ -0,0 +1,74 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/BatchEvaluator.h"
+#include "driver/JitDriver.h"
+
+TEST(MultiThreadedBatchEvaluation, SameResultsAsSingleCall) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+
+  DecisionTree tree = factory.makePerfectRandomTree(8, 20);
+  JitCompileResult result = jitDriver.run(std::move(tree));
+  auto *batchFp = result.BatchEvaluatorFunction;
+
+  uint32_t rows = 10007; // leave a partial chunk
+  DataSetFactory data(std::move(result.Tree), 20);
+  std::vector<float> block = data.makeRandomDataSetBlock(rows);
+
+  std::vector<uint64_t> expected(rows, 0);
+  batchFp(block.data(), 20, rows, expected.data());
+
+  // 1 KiB chunks are 12 rows of 20 features, so there's plenty to steal
+  for (unsigned threads : {1, 3, 8}) {
+    BatchEvaluator evaluator(threads, 1024);
+    std::vector<uint64_t> out(rows, 0);
+    evaluator.run(batchFp, block.data(), 20, rows, out.data());
+
+    EXPECT_EQ(expected, out);
+  }
+}
+
+TEST(MultiThreadedBatchEvaluation, ColumnMajorScores) {
+  DecisionTreeFactory factory;
+  JitDriver jitDriver;
+  jitDriver.setDataSetLayout(DataSetLayout::ColumnMajor);
+
+  DecisionTree tree = factory.makePerfectRandomTree(6, 20);
+  for (uint64_t i = 0; i < 64; i++)
+    tree.setLeafScore(63 + i, 0.25f * i);
+
+  JitCompileResult result = jitDriver.run(std::move(tree));
+  auto *batchFp = result.ScoreBatchEvaluatorFunction;
+
+  // the data block interpreted as 20 columns of rows values each
+  uint32_t rows = 5000;
+  DataSetFactory data(std::move(result.Tree), 20);
+  std::vector<float> block = data.makeRandomDataSetBlock(rows);
+
+  std::vector<float> expected(rows, 0.0f);
+  batchFp(block.data(), rows, rows, expected.data());
+
+  BatchEvaluator evaluator(4, 1024);
+  evaluator.setDataSetLayout(DataSetLayout::ColumnMajor);
+
+  std::vector<float> out(rows, -1.0f);
+  evaluator.run(batchFp, block.data(), rows, rows, out.data());
+
+  EXPECT_EQ(expected, out);
+}
+
+TEST(MultiThreadedBatchEvaluation, EmptyBatch) {
+  BatchEvaluator evaluator(2);
+  std::vector<uint64_t> out(1, 42);
+
+  auto unreachable = [](const float *, size_t, size_t, uint64_t *) {
+    FAIL() << "evaluator must not be called for empty batches";
+  };
+
+  evaluator.run(+unreachable, nullptr, 1, 0, out.data());
+  EXPECT_EQ(42, out[0]);
+}
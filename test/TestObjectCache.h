@@ -0,0 +1,118 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+
+#include "codegen/CodeGeneratorSelector.h"
+#include "codegen/L1IfThenElse.h"
+#include "compiler/ObjectFileCache.h"
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+
+size_t countCachedObjects(const std::string &cacheDir) {
+  size_t count = 0;
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator it(cacheDir, EC), end;
+       it != end && !EC; it.increment(EC)) {
+    if (llvm::StringRef(it->path()).endswith(".o"))
+      count++;
+  }
+  return count;
+}
+
+class ObjectFileCaching : public ::testing::Test {
+protected:
+  std::string CacheDir;
+
+  void SetUp() override {
+    llvm::SmallString<256> dirName;
+    ASSERT_FALSE(
+        llvm::sys::fs::createUniqueDirectory("EvalTreeJit-cache", dirName));
+    CacheDir = dirName.str();
+  }
+
+  void TearDown() override {
+    ObjectFileCache(CacheDir).clear();
+    llvm::sys::fs::remove(CacheDir);
+  }
+};
+
+TEST_F(ObjectFileCaching, WarmStartSameResults) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(8, 20);
+
+  DataSetFactory data(tree.copy(), 20);
+  auto dataSets = data.makeRandomDataSets(100);
+
+  std::vector<uint64_t> expected;
+  {
+    JitDriver coldDriver;
+    coldDriver.enableObjectCache(CacheDir);
+
+    JitCompileResult result = coldDriver.run(tree.copy());
+    for (auto &dataSet : dataSets)
+      expected.push_back(result.EvaluatorFunction(dataSet.data()));
+  }
+
+  EXPECT_EQ(1, countCachedObjects(CacheDir));
+
+  JitDriver warmDriver;
+  warmDriver.enableObjectCache(CacheDir);
+  JitCompileResult result = warmDriver.run(std::move(tree));
+
+  for (size_t i = 0; i < dataSets.size(); i++)
+    EXPECT_EQ(expected[i], result.EvaluatorFunction(dataSets[i].data()));
+
+  std::vector<uint64_t> out(dataSets.size());
+  for (size_t i = 0; i < dataSets.size(); i++)
+    result.BatchEvaluatorFunction(dataSets[i].data(), 20, 1, &out[i]);
+
+  EXPECT_EQ(expected, out);
+  EXPECT_EQ(1, countCachedObjects(CacheDir));
+}
+
+TEST_F(ObjectFileCaching, KeysDependOnConfiguration) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(6, 20);
+
+  JitDriver driver;
+  driver.enableObjectCache(CacheDir);
+
+  driver.run(tree.copy());
+  driver.run(tree.copy());
+  EXPECT_EQ(1, countCachedObjects(CacheDir));
+
+  driver.setDataSetLayout(DataSetLayout::ColumnMajor);
+  driver.run(tree.copy());
+  EXPECT_EQ(2, countCachedObjects(CacheDir));
+
+  driver.setCodegenSelector(std::make_shared<InterleavedSelector>(4));
+  driver.run(tree.copy());
+  EXPECT_EQ(3, countCachedObjects(CacheDir));
+
+  for (uint64_t i = 0; i < 64; i++)
+    tree.setLeafScore(63 + i, 0.25f * i);
+
+  driver.run(std::move(tree));
+  EXPECT_EQ(4, countCachedObjects(CacheDir));
+}
+
+TEST_F(ObjectFileCaching, LambdaSelectorsAreNotCached) {
+  DecisionTreeFactory factory;
+
+  JitDriver driver;
+  driver.enableObjectCache(CacheDir);
+  driver.setCodegenSelector(makeLambdaSelector(
+      [](const CompilerSession &session, int remainingLevels) {
+        static L1IfThenElse codegen;
+        return &codegen;
+      }));
+
+  driver.run(factory.makePerfectRandomTree(6, 20));
+  EXPECT_EQ(0, countCachedObjects(CacheDir));
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "compiler/OptimizationLevel.h"
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+#include "driver/utility/Interpreter.h"
+
+TEST(OptimizationLevels, SameResults) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(9, 20);
+
+  Interpreter interpreter;
+  DataSetFactory data(tree.copy(), 20);
+  std::vector<float> block = data.makeRandomDataSetBlock(100);
+
+  std::vector<uint64_t> expected;
+  for (size_t i = 0; i < 100; i++)
+    expected.push_back(interpreter.run(tree, block.data() + i * 20));
+
+  for (OptimizationLevel level :
+       {OptimizationLevel::Fast, OptimizationLevel::Balanced,
+        OptimizationLevel::Max}) {
+    JitDriver jitDriver;
+    jitDriver.setOptimizationLevel(level);
+    JitCompileResult result = jitDriver.run(tree.copy());
+
+    std::vector<uint64_t> out(100);
+    result.BatchEvaluatorFunction(block.data(), 20, 100, out.data());
+    EXPECT_EQ(expected, out);
+
+    for (size_t i = 0; i < 100; i++)
+      EXPECT_EQ(expected[i], result.EvaluatorFunction(block.data() + i * 20));
+  }
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+#include "driver/utility/Interpreter.h"
+
+TEST(ParallelCompilation, SameResultsAsInterpreter) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(11, 20);
+
+  Interpreter interpreter;
+  DataSetFactory data(tree.copy(), 20);
+  auto dataSets = data.makeRandomDataSets(200);
+
+  std::vector<uint64_t> expected;
+  for (auto &dataSet : dataSets)
+    expected.push_back(interpreter.run(tree, dataSet.data()));
+
+  // split levels that do and don't align with the subtree code generators
+  for (uint8_t splitLevel : {1, 3, 4, 8}) {
+    JitDriver jitDriver;
+    jitDriver.setParallelCompile(splitLevel, 4);
+    JitCompileResult result = jitDriver.run(tree.copy());
+
+    std::vector<uint64_t> out(dataSets.size());
+    for (size_t i = 0; i < dataSets.size(); i++) {
+      EXPECT_EQ(expected[i], result.EvaluatorFunction(dataSets[i].data()));
+      result.BatchEvaluatorFunction(dataSets[i].data(), 20, 1, &out[i]);
+    }
+
+    EXPECT_EQ(expected, out);
+  }
+}
+
+TEST(ParallelCompilation, ColumnMajorScores) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(8, 20);
+  for (uint64_t i = 0; i < 256; i++)
+    tree.setLeafScore(255 + i, 0.25f * i);
+
+  JitDriver referenceDriver;
+  referenceDriver.setDataSetLayout(DataSetLayout::ColumnMajor);
+  JitCompileResult reference = referenceDriver.run(tree.copy());
+
+  JitDriver jitDriver;
+  jitDriver.setDataSetLayout(DataSetLayout::ColumnMajor);
+  jitDriver.setParallelCompile(3, 2);
+  JitCompileResult result = jitDriver.run(std::move(tree));
+
+  uint32_t rows = 1000;
+  DataSetFactory data(std::move(result.Tree), 20);
+  std::vector<float> block = data.makeRandomDataSetBlock(rows);
+
+  std::vector<float> expected(rows, 0.0f);
+  reference.ScoreBatchEvaluatorFunction(block.data(), rows, rows,
+                                        expected.data());
+
+  std::vector<float> out(rows, -1.0f);
+  result.ScoreBatchEvaluatorFunction(block.data(), rows, rows, out.data());
+
+  EXPECT_EQ(expected, out);
+}
+
+TEST(ParallelCompilation, TwoTreesInOneJit) {
+  DecisionTreeFactory factory;
+  DecisionTree tree1 = factory.makePerfectRandomTree(8, 20);
+  DecisionTree tree2 = factory.makePerfectRandomTree(8, 20);
+
+  Interpreter interpreter;
+  DataSetFactory data(tree1.copy(), 20);
+  auto dataSets = data.makeRandomDataSets(100);
+
+  // both trees have subtree functions with equal names
+  JitDriver jitDriver;
+  jitDriver.setParallelCompile(2, 2);
+  JitCompileResult result1 = jitDriver.run(tree1.copy());
+  JitCompileResult result2 = jitDriver.run(tree2.copy());
+
+  for (auto &dataSet : dataSets) {
+    EXPECT_EQ(interpreter.run(tree1, dataSet.data()),
+              result1.EvaluatorFunction(dataSet.data()));
+    EXPECT_EQ(interpreter.run(tree2, dataSet.data()),
+              result2.EvaluatorFunction(dataSet.data()));
+  }
+}
+
+TEST(ParallelCompilation, ConcurrentJitDrivers) {
+  DecisionTreeFactory factory;
+  std::vector<DecisionTree> trees;
+  for (int i = 0; i < 8; i++)
+    trees.push_back(factory.makePerfectRandomTree(8, 20));
+
+  std::vector<uint64_t> results(trees.size());
+  std::vector<float> dataSet(20, 0.5f);
+
+  // one independent JIT per thread, all of them compiling at the same time
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < trees.size(); i++) {
+    threads.emplace_back([&trees, &results, &dataSet, i]() {
+      JitDriver jitDriver;
+      JitCompileResult result = jitDriver.run(trees[i].copy());
+      results[i] = result.EvaluatorFunction(dataSet.data());
+    });
+  }
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  Interpreter interpreter;
+  for (size_t i = 0; i < trees.size(); i++)
+    EXPECT_EQ(interpreter.run(trees[i], dataSet.data()), results[i]);
+}
+
+TEST(ParallelCompilation, SharedTreeHandle) {
+  DecisionTreeFactory factory;
+  DecisionTreeHandle tree =
+      makeTreeHandle(factory.makePerfectRandomTree(9, 20));
+
+  Interpreter interpreter;
+  DataSetFactory data(tree, 20);
+  auto dataSets = data.makeRandomDataSets(100);
+
+  // the subtree sessions and both results use the caller's instance
+  JitDriver jitDriver;
+  jitDriver.setParallelCompile(4, 2);
+  JitCompileResult first = jitDriver.run(tree);
+  JitCompileResult second = jitDriver.run(tree);
+
+  EXPECT_EQ(tree.get(), first.Tree.get());
+  EXPECT_EQ(tree.get(), second.Tree.get());
+
+  for (auto &dataSet : dataSets) {
+    uint64_t expected = interpreter.run(*tree, dataSet.data());
+    EXPECT_EQ(expected, first.EvaluatorFunction(dataSet.data()));
+    EXPECT_EQ(expected, second.EvaluatorFunction(dataSet.data()));
+  }
+}
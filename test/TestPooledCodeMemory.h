@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "compiler/PooledMemoryManager.h"
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+#include "driver/utility/Interpreter.h"
+
+TEST(PooledCodeMemory, AlignsAndCoalesces) {
+  CodeMemoryPool pool;
+
+  uint8_t *a = pool.allocate(100, 16, true);
+  uint8_t *b = pool.allocate(100, 64, true);
+  EXPECT_EQ(0u, (uintptr_t)a % CodeMemoryPool::RegionSize);
+  EXPECT_EQ(0u, (uintptr_t)b % 64);
+  EXPECT_GT(b, a);
+
+  // released neighbours merge into one block that fits both
+  pool.release(a, 100, true);
+  pool.release(b, 100, true);
+  EXPECT_EQ(a, pool.allocate(200, 16, true));
+  EXPECT_EQ(1u, pool.getNumRegions());
+
+  // writable data never shares a region with code
+  uint8_t *data = pool.allocate(100, 16, false);
+  EXPECT_EQ(0u, (uintptr_t)data % CodeMemoryPool::RegionSize);
+  EXPECT_EQ(2u, pool.getNumRegions());
+}
+
+TEST(PooledCodeMemory, ManyModelsShareRegions) {
+  DecisionTreeFactory factory;
+  Interpreter interpreter;
+
+  auto pool = std::make_shared<CodeMemoryPool>();
+  JitDriver jitDriver;
+  jitDriver.setCodeMemoryPool(pool);
+
+  std::vector<DecisionTree> trees;
+  std::vector<JitCompileResult> results;
+  for (int i = 0; i < 50; i++) {
+    trees.push_back(factory.makePerfectRandomTree(6, 20));
+    results.push_back(jitDriver.run(trees.back().copy()));
+  }
+
+  DataSetFactory data(trees.front().copy(), 20);
+  auto dataSets = data.makeRandomDataSets(20);
+
+  for (size_t i = 0; i < trees.size(); i++)
+    for (auto &dataSet : dataSets)
+      EXPECT_EQ(interpreter.run(trees[i], dataSet.data()),
+                results[i].EvaluatorFunction(dataSet.data()));
+
+  // 50 small models fit into a single code region
+  size_t regions = pool->getNumRegions();
+  EXPECT_LE(regions, 2u);
+
+  // unloaded models make room for new ones
+  for (JitCompileResult &result : results)
+    jitDriver.unload(result.ModuleHandle);
+
+  for (int i = 0; i < 50; i++)
+    jitDriver.run(factory.makePerfectRandomTree(6, 20));
+
+  EXPECT_EQ(regions, pool->getNumRegions());
+}
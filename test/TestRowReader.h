@@ -0,0 +1,61 @@
+#pragma once
+
+#include <sstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "driver/utility/RowReader.h"
+
+TEST(RowReader, CsvChunks) {
+  std::istringstream in("1,2,3\n4.5,-5,6e1\n\n7,8,9\r\n10,11,12\n");
+  CsvRowReader reader(in, 3);
+
+  std::vector<float> buffer(2 * 3);
+  ASSERT_EQ(2, reader.read(buffer.data(), 2));
+  EXPECT_EQ((std::vector<float>{1, 2, 3, 4.5f, -5, 60}), buffer);
+
+  // empty line skipped, CRLF line ending accepted
+  ASSERT_EQ(2, reader.read(buffer.data(), 2));
+  EXPECT_EQ((std::vector<float>{7, 8, 9, 10, 11, 12}), buffer);
+
+  EXPECT_EQ(0, reader.read(buffer.data(), 2));
+  EXPECT_FALSE(reader.hasError());
+}
+
+TEST(RowReader, CsvInvalidRow) {
+  std::istringstream in("1,2,3\n4,5,6\n7,8\n9,10,11\n");
+  CsvRowReader reader(in, 3);
+
+  // rows before the invalid one are kept
+  std::vector<float> buffer(4 * 3);
+  ASSERT_EQ(2, reader.read(buffer.data(), 4));
+  EXPECT_EQ(1, buffer[0]);
+  EXPECT_EQ(6, buffer[5]);
+
+  ASSERT_TRUE(reader.hasError());
+  EXPECT_EQ(0, reader.getError().find("Line 3"));
+
+  // no rows after the error
+  EXPECT_EQ(0, reader.read(buffer.data(), 4));
+}
+
+TEST(RowReader, BinaryChunks) {
+  std::vector<float> rows{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  std::string bytes(reinterpret_cast<const char *>(rows.data()),
+                    rows.size() * sizeof(float));
+
+  std::istringstream in(bytes);
+  BinaryRowReader reader(in, 2);
+
+  std::vector<float> buffer(3 * 2);
+  ASSERT_EQ(3, reader.read(buffer.data(), 3));
+  EXPECT_EQ((std::vector<float>{1, 2, 3, 4, 5, 6}), buffer);
+
+  ASSERT_EQ(2, reader.read(buffer.data(), 3));
+  EXPECT_EQ(7, buffer[0]);
+  EXPECT_EQ(10, buffer[3]);
+
+  EXPECT_EQ(0, reader.read(buffer.data(), 3));
+  EXPECT_FALSE(reader.hasError());
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "data/DataSetFactory.h"
+#include "data/DecisionTree.h"
+#include "driver/TieredEvaluator.h"
+#include "driver/utility/Interpreter.h"
+
+TEST(TieredEvaluation, SameResultsBeforeAndAfterSwitch) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(10, 20);
+
+  Interpreter interpreter;
+  DataSetFactory data(tree.copy(), 20);
+  auto dataSets = data.makeRandomDataSets(100);
+
+  std::vector<uint64_t> expected;
+  for (auto &dataSet : dataSets)
+    expected.push_back(interpreter.run(tree, dataSet.data()));
+
+  TieredEvaluator evaluator(std::move(tree));
+
+  // results may come from either tier here
+  for (size_t i = 0; i < dataSets.size(); i++)
+    EXPECT_EQ(expected[i], evaluator.run(dataSets[i].data()));
+
+  evaluator.waitForCompilation();
+  EXPECT_TRUE(evaluator.isCompiled());
+
+  for (size_t i = 0; i < dataSets.size(); i++)
+    EXPECT_EQ(expected[i], evaluator.run(dataSets[i].data()));
+}
+
+TEST(TieredEvaluation, LeafPayloads) {
+  DecisionTreeFactory factory;
+  DecisionTree scoreTree = factory.makePerfectTrivialGradientTree(3);
+  DecisionTree classTree = factory.makePerfectTrivialGradientTree(3);
+  for (uint64_t i = 0; i < 8; i++) {
+    scoreTree.setLeafScore(7 + i, 0.5f * i);
+    classTree.setLeafClassId(7 + i, i % 3);
+  }
+
+  TieredEvaluator scoreEvaluator(std::move(scoreTree));
+  TieredEvaluator classEvaluator(std::move(classTree));
+
+  DataSetFactory data;
+  for (int round = 0; round < 2; round++) {
+    for (uint64_t i = 0; i < 8; i++) {
+      float value = (2 * i + 1) / 16.0f;
+      EXPECT_EQ(0.5f * i,
+                scoreEvaluator.runScore(data.makeTrivialDataSet(value).data()));
+      EXPECT_EQ(i % 3,
+                classEvaluator.run(data.makeTrivialDataSet(value).data()));
+    }
+
+    scoreEvaluator.waitForCompilation();
+    classEvaluator.waitForCompilation();
+  }
+}
+
+TEST(TieredEvaluation, FastTierFirst) {
+  DecisionTreeFactory factory;
+  DecisionTree tree = factory.makePerfectRandomTree(10, 20);
+
+  Interpreter interpreter;
+  DataSetFactory data(tree.copy(), 20);
+  auto dataSets = data.makeRandomDataSets(100);
+
+  std::vector<uint64_t> expected;
+  for (auto &dataSet : dataSets)
+    expected.push_back(interpreter.run(tree, dataSet.data()));
+
+  TieredEvaluator evaluator(std::move(tree), nullptr, true);
+
+  // keep evaluating while the tiers switch
+  while (!evaluator.isCompiled()) {
+    for (size_t i = 0; i < dataSets.size(); i++)
+      EXPECT_EQ(expected[i], evaluator.run(dataSets[i].data()));
+  }
+
+  for (size_t i = 0; i < dataSets.size(); i++)
+    EXPECT_EQ(expected[i], evaluator.run(dataSets[i].data()));
+}
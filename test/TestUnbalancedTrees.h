@@ -0,0 +1,282 @@
+#pragma once
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "codegen/CodeGeneratorSelector.h"
+#include "codegen/L1IfThenElse.h"
+#include "codegen/L3SubtreeSwitchAVX.h"
+#include "codegen/LXSubtreeSwitch.h"
+#include "data/CompactDecisionTree.h"
+#include "data/DataSetFactory.h"
+#include "data/DecisionSubtreeRef.h"
+#include "data/DecisionTree.h"
+#include "driver/JitDriver.h"
+#include "driver/TieredEvaluator.h"
+#include "driver/utility/Interpreter.h"
+
+// tree:
+//          0
+//      1       2
+//   3     4          (2 and 4 are result nodes)
+//  7                 (node 3 has a single child, result node 7)
+static DecisionTree makeSingleChildTree() {
+  DecisionTree tree(3, 3);
+  tree.addNodes(DecisionTreeNode(0, 0.5f, 0, 1, 2),
+                DecisionTreeNode(1, 0.5f, 1, 3, 4),
+                DecisionTreeNode(3, 0.5f, 2, 7, DecisionTreeNode::NoNodeIdx));
+  tree.finalize();
+  return tree;
+}
+
+static std::vector<std::vector<float>> makeSingleChildTreeDataSets() {
+  std::vector<std::vector<float>> dataSets;
+  for (float f0 : {0.0f, 1.0f})
+    for (float f1 : {0.0f, 1.0f})
+      for (float f2 : {0.0f, 1.0f})
+        dataSets.push_back({f0, f1, f2});
+
+  return dataSets;
+}
+
+// Only the leftmost path continues, the right children are results. The
+// index range of deep trees is much larger than their node count, so they
+// are stored sparse. Biases rise with the level, so greater feature values
+// leave the path earlier.
+static DecisionTree makeLeftmostPathTree(uint8_t levels) {
+  DecisionTree tree(levels, levels);
+  for (uint8_t level = 0; level < levels; level++) {
+    uint64_t idx = DecisionTree::getFirstNodeIdxOnLevel(level);
+    float bias = (float)(level + 1) / (levels + 1);
+    tree.addNode(DecisionTreeNode(idx, bias, 0, 2 * idx + 1, 2 * idx + 2));
+  }
+  tree.finalize();
+  return tree;
+}
+
+// evaluates the rows one by one and as a single batch
+static void
+expectSameResultsAsInterpreter(JitDriver &jitDriver, const DecisionTree &tree,
+                               std::vector<std::vector<float>> dataSets) {
+  Interpreter interpreter;
+  JitCompileResult result = jitDriver.run(tree.copy());
+
+  size_t rowStride = dataSets.front().size();
+  std::vector<float> rows;
+  for (const std::vector<float> &dataSet : dataSets)
+    rows.insert(rows.end(), dataSet.begin(), dataSet.end());
+
+  std::vector<uint64_t> out(dataSets.size());
+  result.BatchEvaluatorFunction(rows.data(), rowStride, dataSets.size(),
+                                out.data());
+
+  for (size_t i = 0; i < dataSets.size(); i++) {
+    uint64_t expected = interpreter.run(tree, dataSets[i].data());
+    EXPECT_EQ(expected, result.EvaluatorFunction(dataSets[i].data()));
+    EXPECT_EQ(expected, out[i]);
+  }
+}
+
+static void expectSameResultsAsInterpreter(JitDriver &jitDriver) {
+  expectSameResultsAsInterpreter(jitDriver, makeSingleChildTree(),
+                                 makeSingleChildTreeDataSets());
+
+  DecisionTree pathTree = makeLeftmostPathTree(20);
+  ASSERT_FALSE(pathTree.usesNodeIdxAsSlot());
+  expectSameResultsAsInterpreter(
+      jitDriver, pathTree,
+      {{0.0f}, {0.1f}, {0.3f}, {0.5f}, {0.7f}, {0.9f}, {1.0f}});
+
+  // row counts that aren't a multiple of the batch codegens' block size
+  DecisionTreeFactory factory;
+  for (int i = 0; i < 10; i++) {
+    DecisionTree tree = factory.makeUnbalancedRandomTree(7, 20);
+    DataSetFactory data(tree.copy(), 20);
+    expectSameResultsAsInterpreter(jitDriver, tree,
+                                   data.makeRandomDataSets(50));
+  }
+}
+
+TEST(UnbalancedTrees, Finalize) {
+  DecisionTree tree = makeSingleChildTree();
+
+  EXPECT_EQ(8u, tree.getNodeIdxBound());
+  EXPECT_FALSE(tree.hasNode(5));
+  EXPECT_FALSE(tree.hasNode(6));
+
+  for (uint64_t idx : {2, 4, 7})
+    EXPECT_TRUE(tree.getNode(idx).isImplicit());
+
+  EXPECT_TRUE(tree.getNode(3).hasSingleChild());
+  EXPECT_FALSE(tree.getNode(1).hasSingleChild());
+}
+
+TEST(UnbalancedTrees, SubtreeRef) {
+  DecisionTree tree = makeSingleChildTree();
+
+  DecisionSubtreeRef subtree = tree.getSubtreeRef(0, 3);
+  EXPECT_FALSE(subtree.isComplete());
+  EXPECT_EQ(3, subtree.getNodeCount());
+  EXPECT_EQ(3, subtree.getContinuationNodeCount());
+
+  // result node 2 is not part of the subtree
+  auto nodes = subtree.collectNodesPreOrder();
+  ASSERT_EQ(3, nodes.size());
+  EXPECT_EQ(tree.getNode(0), nodes[0]);
+  EXPECT_EQ(tree.getNode(1), nodes[1]);
+  EXPECT_EQ(tree.getNode(3), nodes[2]);
+
+  DecisionTreeFactory factory;
+  DecisionTree perfectTree = factory.makePerfectRandomTree(4, 10);
+  EXPECT_TRUE(perfectTree.getSubtreeRef(1, 3).isComplete());
+  EXPECT_FALSE(perfectTree.getSubtreeRef(1, 4).isComplete());
+}
+
+TEST(UnbalancedTrees, Interpreter) {
+  DecisionTree tree = makeSingleChildTree();
+  Interpreter interpreter;
+
+  std::vector<uint64_t> expected{7, 7, 4, 4, 2, 2, 2, 2};
+  auto dataSets = makeSingleChildTreeDataSets();
+
+  for (size_t i = 0; i < dataSets.size(); i++) {
+    EXPECT_EQ(expected[i], interpreter.run(tree, dataSets[i].data()));
+    EXPECT_EQ(expected[i],
+              interpreter.runValueBased(tree, dataSets[i].data()));
+  }
+}
+
+TEST(UnbalancedTrees, CompactDecisionTree) {
+  DecisionTreeFactory factory;
+  Interpreter interpreter;
+
+  for (int i = 0; i < 10; i++) {
+    DecisionTree tree = factory.makeUnbalancedRandomTree(8, 20);
+    DataSetFactory data(tree.copy(), 20);
+    auto dataSets = data.makeRandomDataSets(50);
+
+    CompactDecisionTree levelOrderTree(tree);
+    CompactDecisionTree blockedTree(tree, CompactLayout::Blocked, 2);
+
+    for (auto &dataSet : dataSets) {
+      uint64_t expected = interpreter.run(tree, dataSet.data());
+      EXPECT_EQ(expected, interpreter.run(levelOrderTree, dataSet.data()));
+      EXPECT_EQ(expected, interpreter.run(blockedTree, dataSet.data()));
+    }
+  }
+}
+
+// result node indices beyond 32 bits
+TEST(UnbalancedTrees, DeepSparseCompactTree) {
+  DecisionTree tree = makeLeftmostPathTree(40);
+  Interpreter interpreter;
+
+  std::vector<std::vector<float>> dataSets{{0.0f}, {0.5f}, {1.0f}};
+  ASSERT_GT(interpreter.run(tree, dataSets[0].data()), PowerOf2(32));
+
+  CompactDecisionTree levelOrderTree(tree);
+  CompactDecisionTree blockedTree(tree, CompactLayout::Blocked, 3);
+
+  for (auto &dataSet : dataSets) {
+    uint64_t expected = interpreter.run(tree, dataSet.data());
+    EXPECT_EQ(expected, interpreter.run(levelOrderTree, dataSet.data()));
+    EXPECT_EQ(expected, interpreter.run(blockedTree, dataSet.data()));
+  }
+
+  // the interpreter tier looks up class ids by result node index
+  for (uint64_t slot = 0; slot < tree.getNumNodeSlots(); slot++) {
+    const DecisionTreeNode &node = tree.getNodeInSlot(slot);
+    if (node.isImplicit())
+      tree.setLeafClassId(node.getIdx(),
+                          DecisionTree::getLevelForNodeIdx(node.getIdx()));
+  }
+
+  std::vector<uint64_t> expected;
+  for (auto &dataSet : dataSets)
+    expected.push_back(
+        tree.getLeafClassId(interpreter.run(tree, dataSet.data())));
+
+  TieredEvaluator evaluator(std::move(tree));
+  for (size_t i = 0; i < dataSets.size(); i++)
+    EXPECT_EQ(expected[i], evaluator.run(dataSets[i].data()));
+
+  evaluator.waitForCompilation();
+  for (size_t i = 0; i < dataSets.size(); i++)
+    EXPECT_EQ(expected[i], evaluator.run(dataSets[i].data()));
+}
+
+// the given codegen evaluates as many levels as it can, L1IfThenElse does
+// the rest
+static void expectSameResultsAsInterpreter(CodeGenerator *codegen) {
+  JitDriver jitDriver;
+  jitDriver.setCodegenSelector(makeLambdaSelector(
+      [codegen](const CompilerSession &session,
+                int remainingLevels) -> CodeGenerator * {
+        static L1IfThenElse remainder;
+        return (remainingLevels < codegen->getJointSubtreeDepth())
+                   ? &remainder : codegen;
+      }));
+
+  expectSameResultsAsInterpreter(jitDriver);
+}
+
+TEST(UnbalancedTrees, DefaultSelector) {
+  JitDriver jitDriver;
+  expectSameResultsAsInterpreter(jitDriver);
+}
+
+TEST(UnbalancedTrees, L1IfThenElse) {
+  L1IfThenElse codegen;
+  expectSameResultsAsInterpreter(&codegen);
+}
+
+TEST(UnbalancedTrees, L2SubtreeSwitch) {
+  LXSubtreeSwitch codegen(2);
+  expectSameResultsAsInterpreter(&codegen);
+}
+
+TEST(UnbalancedTrees, L3SubtreeSwitch) {
+  LXSubtreeSwitch codegen(3);
+  expectSameResultsAsInterpreter(&codegen);
+}
+
+TEST(UnbalancedTrees, L3SubtreeSwitchAVX) {
+  L3SubtreeSwitchAVX codegen;
+  expectSameResultsAsInterpreter(&codegen);
+}
+
+TEST(UnbalancedTrees, L4SubtreeSwitch) {
+  LXSubtreeSwitch codegen(4);
+  expectSameResultsAsInterpreter(&codegen);
+}
+
+TEST(UnbalancedTrees, BatchInterleavedSelect) {
+  JitDriver jitDriver;
+  jitDriver.setCodegenSelector(std::make_shared<InterleavedSelector>(4));
+  expectSameResultsAsInterpreter(jitDriver);
+}
+
+// unbalanced trees are no perfect level-order trees, so the batch
+// evaluators fall back to per-row evaluation
+TEST(UnbalancedTrees, DataParallelAVXFallback) {
+  JitDriver jitDriver;
+  jitDriver.setCodegenSelector(std::make_shared<DataParallelAVXSelector>());
+  expectSameResultsAsInterpreter(jitDriver);
+}
+
+TEST(UnbalancedTrees, ParallelCompile) {
+  for (uint8_t splitLevel : {1, 3, 5}) {
+    JitDriver jitDriver;
+    jitDriver.setParallelCompile(splitLevel, 2);
+    expectSameResultsAsInterpreter(jitDriver);
+  }
+}
+
+TEST(UnbalancedTrees, LazyCompile) {
+  for (uint8_t splitLevel : {1, 3, 5}) {
+    JitDriver jitDriver;
+    jitDriver.setLazyCompile(splitLevel);
+    expectSameResultsAsInterpreter(jitDriver);
+  }
+}